@@ -0,0 +1,90 @@
+#include "camera.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+Camera::Camera(sf::Vector2f screenSize, const Rect &world)
+    : _screenSize(screenSize), _world(world) {
+  assert(screenSize.x > 0.f && screenSize.y > 0.f);
+  assert(world.width > 0.f && world.height > 0.f);
+  view.setSize(screenSize);
+  view.setCenter(world.left + world.width / 2.f,
+                 world.top + world.height / 2.f);
+  clampToWorld();
+}
+
+void Camera::handleEvent(const sf::Event &event,
+                         const sf::RenderWindow &window) {
+  if (event.type == sf::Event::MouseWheelScrolled &&
+      event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+    // zoom keeps the world point under the arrow still
+    sf::Vector2f anchor = window.mapPixelToCoords(
+        {event.mouseWheelScroll.x, event.mouseWheelScroll.y}, view);
+    zoomAt(event.mouseWheelScroll.delta > 0 ? 1.f / zoomStep : zoomStep,
+           anchor);
+  }
+
+  if (event.type == sf::Event::KeyPressed) {
+    sf::Vector2f pan = view.getSize() * panFraction;
+    switch (event.key.code) {
+      case sf::Keyboard::Left:
+        view.move(-pan.x, 0.f);
+        break;
+      case sf::Keyboard::Right:
+        view.move(pan.x, 0.f);
+        break;
+      case sf::Keyboard::Up:
+        view.move(0.f, -pan.y);
+        break;
+      case sf::Keyboard::Down:
+        view.move(0.f, pan.y);
+        break;
+      case sf::Keyboard::Add:
+      case sf::Keyboard::Equal:
+        zoomAt(1.f / zoomStep, view.getCenter());
+        break;
+      case sf::Keyboard::Subtract:
+      case sf::Keyboard::Hyphen:
+        zoomAt(zoomStep, view.getCenter());
+        break;
+      default:
+        break;
+    }
+    clampToWorld();
+  }
+}
+
+const sf::View &Camera::getView() const { return view; }
+
+Rect Camera::getVisibleArea() const {
+  sf::Vector2f size = view.getSize();
+  sf::Vector2f corner = view.getCenter() - size / 2.f;
+  return {corner.x, corner.y, size.x, size.y};
+}
+
+float Camera::getZoom() const { return zoom; }
+
+void Camera::zoomAt(float factor, sf::Vector2f anchor) {
+  // never zoom out further than the whole world on screen
+  float maxZoom = std::max(_world.width / _screenSize.x,
+                           _world.height / _screenSize.y);
+  float newZoom = std::clamp(zoom * factor, minZoom, std::max(maxZoom, 1.f));
+  float ratio = newZoom / zoom;
+  zoom = newZoom;
+
+  view.setSize(_screenSize * zoom);
+  view.setCenter(anchor + (view.getCenter() - anchor) * ratio);
+  clampToWorld();
+}
+
+void Camera::clampToWorld() {
+  // the view stays over the world, centered on it when larger than it
+  sf::Vector2f half = view.getSize() / 2.f;
+  sf::Vector2f center = view.getCenter();
+  auto clampAxis = [](float value, float low, float length, float halfView) {
+    if (2 * halfView >= length) return low + length / 2.f;
+    return std::clamp(value, low + halfView, low + length - halfView);
+  };
+  view.setCenter(clampAxis(center.x, _world.left, _world.width, half.x),
+                 clampAxis(center.y, _world.top, _world.height, half.y));
+}
@@ -0,0 +1,33 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <SFML/Graphics.hpp>
+
+#include "geometry.hpp"
+
+// view over a world that may be larger than the window: arrow keys pan,
+// the mouse wheel and +/- zoom
+class Camera {
+ public:
+  Camera(sf::Vector2f screenSize, const Rect &world);
+
+  void handleEvent(const sf::Event &event, const sf::RenderWindow &window);
+
+  const sf::View &getView() const;
+  Rect getVisibleArea() const;  // world area currently on screen
+  float getZoom() const;        // world units per screen pixel
+
+ private:
+  void zoomAt(float factor, sf::Vector2f anchor);
+  void clampToWorld();
+
+  sf::View view;
+  sf::Vector2f _screenSize;
+  Rect _world;
+  float zoom = 1.f;
+  static constexpr float panFraction = 0.1f;  // of the view per key press
+  static constexpr float zoomStep = 1.2f;
+  static constexpr float minZoom = 0.1f;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "boid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+//------parameters-------
+void BoidParams::SetRadii(float baseSize, float factor1, float factor2,
+                          float factor3) {
+  assert(baseSize > 0 && factor1 > 0 && factor2 > 0 && factor3 > 0);
+  radius = baseSize;
+  separation = baseSize * factor1;
+  cohesion = baseSize * factor2;
+  alignment = baseSize * factor3;
+}
+
+//------constrctors and destructors-------
+Boid::Boid()
+    : Velocity{0, 0},
+      Position{0, 0},
+      PreviousPosition{0, 0},
+      _params(&kDefaultBoidParams) {}
+Boid::Boid(Vec2 position, Vec2 velocity, const BoidParams *params)
+    : Velocity{velocity},
+      Position{position},
+      PreviousPosition{position},
+      _params(params) {
+  assert(params != nullptr);
+}
+
+//------getters-------
+Vec2 Boid::GetPosition() const { return {Position.x, Position.y}; }
+Vec2 Boid::GetVelocity() const { return {Velocity.x, Velocity.y}; }
+Vec2 Boid::GetPreviousPosition() const { return PreviousPosition; }
+float Boid::GetRadius() const { return _params->radius; }
+float Boid::GetRadiusSep() const { return _params->separation; }
+float Boid::GetRadiusCoh() const { return _params->cohesion; }
+float Boid::GetRadiusAlg() const { return _params->alignment; }
+int Boid::GetDamage() const { return damage; }
+bool Boid::GetDamageType() const { return _params->gradualDamage; }
+const BoidParams &Boid::GetParams() const { return *_params; }
+bool Boid::GetHitStatus() const { return isHit; }
+float Boid::GetTimer() const { return hitTimer; }
+
+//------setters-------
+void Boid::SetHitStatus(bool hit) { this->isHit = hit; }
+void Boid::SetTimer(float time) { this->hitTimer = time; }
+
+//------direct variables modifiers-------
+void Boid::SpeedChange(Vec2 changedSpeed) {
+  // the function changes the velocity vector instantly
+  float maxSpeed = _params->maxSpeed;
+  float speed = Norm(changedSpeed);
+  if (speed > maxSpeed) {
+    this->Velocity = (changedSpeed / speed) * maxSpeed;
+  } else {
+    this->Velocity = changedSpeed;
+  }
+}
+void Boid::SetPosition(Vec2 pos) {
+  // a placement is not a motion, so there is nothing to interpolate
+  this->Position = pos;
+  this->PreviousPosition = pos;
+}
+
+//------evolution functions------
+void Boid::Update_Position(float dt) {
+  PreviousPosition = Position;
+  Position += Velocity * (dt * kReferenceRate);
+}
+void Boid::MarkHit() {
+  // marks the begin of the "hit status" and orders the "damage colour change"
+  if (isHit) {
+    hitTimer = std::max(hitTimer, 0.f);  // exclude negative timer values
+  } else {
+    isHit = true;
+    ApplyDamage(_params->gradualDamage ? 1 : 4);
+  }
+}
+bool Boid::UpdateHit(float deltaTime) {
+  // tells whether the boid should be destroyed or not and in which situations
+  if (!isHit) return false;
+
+  hitTimer -= deltaTime;
+  if (hitTimer > 0.f) {
+    return false;  // still frozen
+  }
+
+  if (damage >= 4) {
+    return true;  // should be destroyed
+  }
+
+  return false;  // default not destroyed
+}
+void Boid::ApplyDamage(int level) {
+  // raises the damage level, the renderer maps it to one of three colours
+  if (hitColorChanged) return;
+  damage += level;
+}
@@ -0,0 +1,76 @@
+#ifndef BOID_HPP
+#define BOID_HPP
+
+#include <vector>
+
+#include "geometry.hpp"
+
+// velocities are measured in world units per reference tick, so a step of
+// kReferenceStep seconds reproduces the original per-frame motion
+inline constexpr float kReferenceRate = 120.f;
+inline constexpr float kReferenceStep = 1.f / kReferenceRate;
+
+// shape, limits and damage mode shared by the boids of one simulation
+struct BoidParams {
+  float radius = 5.f;       // body size
+  float separation = 20.f;  // separation radius
+  float cohesion = 50.f;    // cohesion radius
+  float alignment = 150.f;  // alignment radius
+  float maxSpeed = 3e-1f;
+  bool gradualDamage = false;
+
+  // the three radii as multiples of the body size
+  void SetRadii(float baseSize, float factor1, float factor2, float factor3);
+};
+
+inline constexpr BoidParams kDefaultBoidParams{};
+
+class Boid {
+ public:
+  //------constrctors and destructors-------
+  // the parameters are shared, not copied: they must outlive the boid
+  Boid();
+  Boid(Vec2 position, Vec2 velocity,
+       const BoidParams *params = &kDefaultBoidParams);
+  virtual ~Boid() = default;
+  //------getters-------
+  Vec2 GetPosition() const;
+  Vec2 GetVelocity() const;
+  Vec2 GetPreviousPosition() const;
+  float GetRadius() const;
+  float GetRadiusCoh() const;
+  float GetRadiusSep() const;
+  float GetRadiusAlg() const;
+  float GetTimer() const;
+  bool GetHitStatus() const;
+  bool GetDamageType() const;
+  int GetDamage() const;
+  const BoidParams &GetParams() const;
+  //------setters-------
+  void SetTimer(float time);
+  void SetHitStatus(bool hit);
+  //------direct variables modifiers-----
+  virtual void SpeedChange(Vec2 changedSpeed);
+  void SetPosition(Vec2 pos);
+  //------evolution functions------
+  virtual void Update_Position(float dt);
+  void MarkHit();
+  bool UpdateHit(float deltaTime);
+  void ApplyDamage(int level);
+
+ protected:
+  Vec2 Velocity;
+  Vec2 Position;
+  Vec2 PreviousPosition;  // position before the last step, for interpolation
+
+ private:
+  //------shape, limit and mode variables--------
+  const BoidParams *_params;
+  //------impact variables-------
+  int damage = 0;
+  float hitTimer = 1.f;
+  bool isHit = false;
+  bool hitColorChanged = false;
+};
+
+#endif
\ No newline at end of file
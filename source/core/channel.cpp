@@ -0,0 +1,179 @@
+#include "channel.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+using Length = std::uint64_t;  // prefix of every message
+
+// progress of one message in each direction of a channel
+struct Transfer {
+  std::vector<char> frame;  // outgoing prefix and payload
+  std::size_t sent = 0;
+  char header[sizeof(Length)] = {};
+  std::size_t headerRead = 0;
+  std::size_t payloadRead = 0;
+  bool received = false;
+};
+
+std::vector<char> Frame(const std::vector<char> &message) {
+  Length length = message.size();
+  std::vector<char> frame(sizeof(length) + message.size());
+  std::memcpy(frame.data(), &length, sizeof(length));
+  if (!message.empty()) {
+    std::memcpy(frame.data() + sizeof(length), message.data(),
+                message.size());
+  }
+  return frame;
+}
+
+// bytes moved, 0 when the call would block, -1 on failure or hang up
+long Write(int fd, const char *data, std::size_t size) {
+  for (;;) {
+    ssize_t n = send(fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n >= 0) return n;
+    if (errno == EINTR) continue;
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+}
+long Read(int fd, char *data, std::size_t size) {
+  for (;;) {
+    ssize_t n = recv(fd, data, size, MSG_DONTWAIT);
+    if (n > 0) return n;
+    if (n == 0) return -1;  // peer closed before the whole message arrived
+    if (errno == EINTR) continue;
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+}
+
+bool Advance(int fd, Transfer &transfer, std::vector<char> &in,
+             short events) {
+  if ((events & POLLOUT) && transfer.sent < transfer.frame.size()) {
+    long n = Write(fd, transfer.frame.data() + transfer.sent,
+                   transfer.frame.size() - transfer.sent);
+    if (n < 0) return false;
+    transfer.sent += static_cast<std::size_t>(n);
+  }
+  if ((events & (POLLIN | POLLHUP)) && !transfer.received) {
+    if (transfer.headerRead < sizeof(Length)) {
+      long n = Read(fd, transfer.header + transfer.headerRead,
+                    sizeof(Length) - transfer.headerRead);
+      if (n < 0) return false;
+      transfer.headerRead += static_cast<std::size_t>(n);
+      if (transfer.headerRead == sizeof(Length)) {
+        Length length;
+        std::memcpy(&length, transfer.header, sizeof(length));
+        in.resize(static_cast<std::size_t>(length));
+      }
+    } else if (transfer.payloadRead < in.size()) {
+      long n = Read(fd, in.data() + transfer.payloadRead,
+                    in.size() - transfer.payloadRead);
+      if (n < 0) return false;
+      transfer.payloadRead += static_cast<std::size_t>(n);
+    }
+    transfer.received = transfer.headerRead == sizeof(Length) &&
+                        transfer.payloadRead == in.size();
+  }
+  return !(events & (POLLERR | POLLNVAL));
+}
+
+}  // namespace
+
+Channel::Channel(int fd) : _fd(fd) {}
+Channel::~Channel() { Close(); }
+Channel::Channel(Channel &&other) noexcept
+    : _fd(std::exchange(other._fd, -1)) {}
+Channel &Channel::operator=(Channel &&other) noexcept {
+  if (this != &other) {
+    Close();
+    _fd = std::exchange(other._fd, -1);
+  }
+  return *this;
+}
+
+bool Channel::CreatePair(Channel &first, Channel &second) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return false;
+  first = Channel(fds[0]);
+  second = Channel(fds[1]);
+  return true;
+}
+
+bool Channel::IsOpen() const { return _fd >= 0; }
+int Channel::GetFd() const { return _fd; }
+void Channel::Close() {
+  if (_fd >= 0) close(_fd);
+  _fd = -1;
+}
+
+bool Channel::Send(const std::vector<char> &message) {
+  std::vector<char> frame = Frame(message);
+  std::size_t sent = 0;
+  while (sent < frame.size()) {
+    pollfd entry{_fd, POLLOUT, 0};
+    if (poll(&entry, 1, -1) < 0 && errno != EINTR) return false;
+    long n = Write(_fd, frame.data() + sent, frame.size() - sent);
+    if (n < 0) return false;
+    sent += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+bool Channel::Receive(std::vector<char> &message) {
+  Transfer transfer;
+  while (!transfer.received) {
+    pollfd entry{_fd, POLLIN, 0};
+    if (poll(&entry, 1, -1) < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (!Advance(_fd, transfer, message, entry.revents)) return false;
+  }
+  return true;
+}
+
+bool Exchange(const std::vector<Channel *> &channels,
+              const std::vector<std::vector<char>> &out,
+              std::vector<std::vector<char>> &in) {
+  std::size_t count = channels.size();
+  if (out.size() != count) return false;
+  in.assign(count, {});
+
+  std::vector<Transfer> transfers(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    transfers[i].frame = Frame(out[i]);
+  }
+
+  // every channel is polled for both directions until all messages are out
+  // and all replies are in
+  std::vector<pollfd> entries(count);
+  for (;;) {
+    bool done = true;
+    for (std::size_t i = 0; i < count; ++i) {
+      const Transfer &transfer = transfers[i];
+      short events = 0;
+      if (transfer.sent < transfer.frame.size()) events |= POLLOUT;
+      if (!transfer.received) events |= POLLIN;
+      entries[i] = {channels[i]->GetFd(), events, 0};
+      done = done && events == 0;
+    }
+    if (done) return true;
+
+    if (poll(entries.data(), entries.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      if (entries[i].revents == 0) continue;
+      if (!Advance(entries[i].fd, transfers[i], in[i], entries[i].revents)) {
+        return false;
+      }
+    }
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef CHANNEL_HPP
+#define CHANNEL_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// one end of a connected stream socket (socket pair, Unix domain or TCP)
+// carrying length prefixed messages; failures are reported as false, the
+// peer having gone away included
+class Channel {
+ public:
+  Channel() = default;
+  explicit Channel(int fd);
+  ~Channel();
+  Channel(Channel &&other) noexcept;
+  Channel &operator=(Channel &&other) noexcept;
+  Channel(const Channel &) = delete;
+  Channel &operator=(const Channel &) = delete;
+
+  // two connected ends on this machine, e.g. for a parent and its child
+  static bool CreatePair(Channel &first, Channel &second);
+
+  bool IsOpen() const;
+  int GetFd() const;
+  void Close();
+
+  // blocking, one whole message each
+  bool Send(const std::vector<char> &message);
+  bool Receive(std::vector<char> &message);
+
+ private:
+  int _fd = -1;
+};
+
+// sends out[i] on channels[i] while receiving in[i] from it, all at once:
+// neighbours that exchange with each other at the same time cannot block
+// each other on full socket buffers
+bool Exchange(const std::vector<Channel *> &channels,
+              const std::vector<std::vector<char>> &out,
+              std::vector<std::vector<char>> &in);
+
+//------message packing-------
+
+template <class T>
+void Pack(const std::vector<T> &records, std::vector<char> &message) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  message.resize(records.size() * sizeof(T));
+  if (!records.empty()) {
+    std::memcpy(message.data(), records.data(), message.size());
+  }
+}
+
+template <class T>
+bool Unpack(const std::vector<char> &message, std::vector<T> &records) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  if (message.size() % sizeof(T) != 0) return false;
+  records.resize(message.size() / sizeof(T));
+  if (!records.empty()) {
+    std::memcpy(records.data(), message.data(), message.size());
+  }
+  return true;
+}
+
+#endif
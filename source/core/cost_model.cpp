@@ -0,0 +1,67 @@
+#include "cost_model.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+float CostModel::PredictCost(std::uint32_t neighbors) const {
+  return boidOverhead + static_cast<float>(neighbors);
+}
+
+float CostModel::GetBoidOverhead() const { return boidOverhead; }
+
+void CostModel::Partition(const std::vector<std::uint32_t> &neighborCounts,
+                          std::size_t parts,
+                          std::vector<std::size_t> &bounds) const {
+  assert(parts > 0);
+  bounds.clear();
+  bounds.push_back(0);
+  std::size_t count = neighborCounts.size();
+  if (count == 0) return;
+
+  double total = 0.0;
+  for (std::uint32_t neighbors : neighborCounts) {
+    total += PredictCost(neighbors);
+  }
+  double target = total / static_cast<double>(parts);
+
+  // cut every time the running cost passes the next multiple of the target
+  double running = 0.0;
+  double nextCut = target;
+  for (std::size_t i = 0; i < count; ++i) {
+    running += PredictCost(neighborCounts[i]);
+    if (running >= nextCut && i + 1 < count &&
+        bounds.size() < parts) {
+      bounds.push_back(i + 1);
+      while (nextCut <= running) nextCut += target;
+    }
+  }
+  bounds.push_back(count);
+}
+
+void CostModel::Fit(const std::vector<ChunkSample> &samples) {
+  // least squares for seconds = a * boids + b * neighbors; the ratio a / b
+  // is the overhead of a boid in neighbor units
+  double sbb = 0.0, sbn = 0.0, snn = 0.0, sbt = 0.0, snt = 0.0;
+  for (const ChunkSample &sample : samples) {
+    double b = static_cast<double>(sample.boids);
+    double n = static_cast<double>(sample.neighbors);
+    double t = static_cast<double>(sample.seconds);
+    sbb += b * b;
+    sbn += b * n;
+    snn += n * n;
+    sbt += b * t;
+    snt += n * t;
+  }
+
+  // chunks of the same density give no information about the split
+  double det = sbb * snn - sbn * sbn;
+  if (det <= 1e-6 * sbb * snn) return;
+  double a = (snn * sbt - sbn * snt) / det;
+  double b = (sbb * snt - sbn * sbt) / det;
+  if (a <= 0.0 || b <= 0.0) return;
+
+  // smoothed, so a single noisy step (preemption, page faults) cannot
+  // throw the partition off
+  float measured = std::clamp(static_cast<float>(a / b), 0.5f, 1000.f);
+  boidOverhead = 0.8f * boidOverhead + 0.2f * measured;
+}
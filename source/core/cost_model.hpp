@@ -0,0 +1,37 @@
+#ifndef COST_MODEL_HPP
+#define COST_MODEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// measured work of one chunk of the rule evaluation
+struct ChunkSample {
+  std::size_t boids = 0;
+  std::size_t neighbors = 0;
+  float seconds = 0.f;
+};
+
+// predicts the rule evaluation cost of every boid from the neighbors it had
+// in the previous step, and splits the boids into chunks of about equal
+// predicted cost instead of equal boid counts
+class CostModel {
+ public:
+  // cost of one boid, in units of one visited neighbor
+  float PredictCost(std::uint32_t neighbors) const;
+  float GetBoidOverhead() const;
+
+  // bounds receives the chunk limits: chunk c is [bounds[c], bounds[c + 1]);
+  // there are at most `parts` chunks and none of them is empty
+  void Partition(const std::vector<std::uint32_t> &neighborCounts,
+                 std::size_t parts, std::vector<std::size_t> &bounds) const;
+
+  // refits the per boid overhead against the time measured for each chunk
+  void Fit(const std::vector<ChunkSample> &samples);
+
+ private:
+  // fixed work per boid (query, bookkeeping) next to the per neighbor work
+  float boidOverhead = 8.f;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "counter_rng.hpp"
+
+#include <cassert>
+
+CounterRng::CounterRng(std::uint64_t seed, std::uint64_t stream,
+                       std::uint32_t step)
+    : key{static_cast<std::uint32_t>(seed),
+          static_cast<std::uint32_t>(seed >> 32)},
+      counter{0, step, static_cast<std::uint32_t>(stream),
+              static_cast<std::uint32_t>(stream >> 32)} {}
+
+std::uint32_t CounterRng::NextU32() {
+  if (used == 4) {
+    block = Philox4x32(counter, key);
+    ++counter[0];  // 2^32 blocks per stream and step
+    used = 0;
+  }
+  return block[used++];
+}
+
+float CounterRng::NextFloat() {
+  // the top 24 bits, exactly representable in a float
+  return static_cast<float>(NextU32() >> 8) * 0x1p-24f;
+}
+
+float CounterRng::Uniform(float min, float max) {
+  assert(min <= max);
+  return min + (max - min) * NextFloat();
+}
+
+void SpawnUniform(std::uint64_t seed, std::uint64_t firstId, std::size_t count,
+                  const Rect &area, float maxSpeed,
+                  std::vector<Vec2> &positions, std::vector<Vec2> &velocities,
+                  ThreadPool *pool) {
+  positions.resize(count);
+  velocities.resize(count);
+  auto spawn = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      CounterRng rng(seed, firstId + i);
+      positions[i] = {rng.Uniform(area.left, area.left + area.width),
+                      rng.Uniform(area.top, area.top + area.height)};
+      velocities[i] = {rng.Uniform(-maxSpeed, maxSpeed),
+                       rng.Uniform(-maxSpeed, maxSpeed)};
+    }
+  };
+
+  if (pool != nullptr) {
+    pool->ParallelFor(count, 16384, spawn);
+  } else {
+    spawn(0, count);
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef COUNTER_RNG_HPP
+#define COUNTER_RNG_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.hpp"
+#include "thread_pool.hpp"
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+// 3"): a keyed bijection of a 128 bit counter, so the n-th number of a
+// stream is computed directly, without the n-1 before it
+using PhiloxCounter = std::array<std::uint32_t, 4>;
+using PhiloxKey = std::array<std::uint32_t, 2>;
+
+constexpr PhiloxCounter Philox4x32(PhiloxCounter counter, PhiloxKey key) {
+  constexpr std::uint64_t M0 = 0xD2511F53;
+  constexpr std::uint64_t M1 = 0xCD9E8D57;
+  constexpr std::uint32_t W0 = 0x9E3779B9;  // key schedule (golden ratio)
+  constexpr std::uint32_t W1 = 0xBB67AE85;  // (sqrt(3) - 1)
+  for (int round = 0; round < 10; ++round) {
+    if (round > 0) {
+      key[0] += W0;
+      key[1] += W1;
+    }
+    std::uint64_t p0 = M0 * counter[0];
+    std::uint64_t p1 = M1 * counter[2];
+    counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+               static_cast<std::uint32_t>(p1),
+               static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+               static_cast<std::uint32_t>(p0)};
+  }
+  return counter;
+}
+
+// stream of numbers keyed by (seed, stream, step): e.g. the boid index as
+// stream and the simulation step as step. Any thread can open any stream
+// and gets the same numbers, in any order of creation.
+class CounterRng {
+ public:
+  CounterRng(std::uint64_t seed, std::uint64_t stream, std::uint32_t step = 0);
+
+  std::uint32_t NextU32();
+  float NextFloat();  // [0, 1)
+  float Uniform(float min, float max);
+
+ private:
+  PhiloxKey key;
+  PhiloxCounter counter;  // block, step, stream
+  PhiloxCounter block{};
+  std::size_t used = 4;  // numbers of the current block already handed out
+};
+
+// count boids spread uniformly over area, with each velocity component in
+// [-maxSpeed, maxSpeed]; boid i is drawn from stream firstId + i alone, so
+// the result is the same with or without a pool
+void SpawnUniform(std::uint64_t seed, std::uint64_t firstId, std::size_t count,
+                  const Rect &area, float maxSpeed,
+                  std::vector<Vec2> &positions, std::vector<Vec2> &velocities,
+                  ThreadPool *pool = nullptr);
+
+#endif
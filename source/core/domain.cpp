@@ -0,0 +1,332 @@
+#include "domain.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+//------records-------
+
+BoidRecord ToRecord(const Boid &boid) {
+  BoidRecord record;
+  record.position = boid.GetPosition();
+  record.velocity = boid.GetVelocity();
+  record.hitTimer = boid.GetTimer();
+  record.damage = boid.GetDamage();
+  record.hit = boid.GetHitStatus() ? 1 : 0;
+  return record;
+}
+
+Boid FromRecord(const BoidRecord &record, const BoidParams *params) {
+  Boid boid(record.position, record.velocity, params);
+  boid.SetTimer(record.hitTimer);
+  boid.SetHitStatus(record.hit != 0);
+  boid.ApplyDamage(record.damage);
+  return boid;
+}
+
+//------strips-------
+
+StripDecomposition::StripDecomposition(float width, int ranks)
+    : _width(width), _ranks(ranks) {
+  assert(width > 0.f && ranks > 0);
+}
+
+int StripDecomposition::GetRanks() const { return _ranks; }
+float StripDecomposition::GetLeft(int rank) const {
+  return _width * static_cast<float>(rank) / static_cast<float>(_ranks);
+}
+float StripDecomposition::GetRight(int rank) const { return GetLeft(rank + 1); }
+
+int StripDecomposition::OwnerOf(float x) const {
+  // same boundaries as GetLeft, so ownership and halos always agree
+  int rank = 0;
+  while (rank + 1 < _ranks && x >= GetLeft(rank + 1)) ++rank;
+  return rank;
+}
+
+//------worker-------
+
+DomainWorker::DomainWorker(const DomainSettings &settings, int rank,
+                           Channel *left, Channel *right)
+    : _settings(settings),
+      strips(settings.width, settings.ranks),
+      _rank(rank),
+      _left(left),
+      _right(right),
+      haloWidth(std::max({settings.params.separation, settings.params.cohesion,
+                          settings.params.alignment})),
+      tree(0.f, 0.f, settings.width, settings.height, 4) {
+  assert(rank >= 0 && rank < settings.ranks);
+  assert((settings.ranks == 1) == (left == nullptr && right == nullptr));
+  // halos come from the adjacent strips only
+  assert(settings.ranks == 1 ||
+         strips.GetRight(0) - strips.GetLeft(0) >= haloWidth);
+}
+
+void DomainWorker::AddBoid(const BoidRecord &record) {
+  boids.push_back(FromRecord(record, &_settings.params));
+}
+void DomainWorker::AddObstacle(const Obstacle &obstacle) {
+  obstacles.push_back(obstacle);
+}
+const std::vector<Boid> &DomainWorker::GetBoids() const { return boids; }
+const DomainStats &DomainWorker::GetStats() const { return stats; }
+
+bool DomainWorker::Step() {
+  auto start = std::chrono::steady_clock::now();
+  if (!ExchangeHalo()) return false;
+  Evolve();
+  if (!Migrate()) return false;
+
+  ++stats.steps;
+  stats.boids = boids.size();
+  stats.seconds += std::chrono::duration<float>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return true;
+}
+
+bool DomainWorker::Trade(const std::vector<BoidRecord> &leftOut,
+                         const std::vector<BoidRecord> &rightOut,
+                         std::vector<BoidRecord> &in) {
+  in.clear();
+  if (_left == nullptr) return true;  // single rank
+
+  // both channels always carry a message, possibly empty, so every rank
+  // knows when its neighbours are done with the step
+  std::vector<std::vector<char>> out(2);
+  Pack(leftOut, out[0]);
+  Pack(rightOut, out[1]);
+  stats.bytesSent += out[0].size() + out[1].size();
+
+  std::vector<std::vector<char>> messages;
+  if (!Exchange({_left, _right}, out, messages)) return false;
+
+  std::vector<BoidRecord> records;
+  for (const std::vector<char> &message : messages) {
+    if (!Unpack(message, records)) return false;
+    in.insert(in.end(), records.begin(), records.end());
+  }
+  return true;
+}
+
+bool DomainWorker::ExchangeHalo() {
+  // the boids within reach of a neighbouring strip; nothing is sent across
+  // the wrap, since the boids never see each other through the borders
+  int last = _settings.ranks - 1;
+  float x0 = strips.GetLeft(_rank);
+  float x1 = strips.GetRight(_rank);
+  toLeft.clear();
+  toRight.clear();
+  for (const Boid &boid : boids) {
+    float x = boid.GetPosition().x;
+    if (_rank > 0 && x < x0 + haloWidth) toLeft.push_back(ToRecord(boid));
+    if (_rank < last && x >= x1 - haloWidth) toRight.push_back(ToRecord(boid));
+  }
+  stats.haloSent += toLeft.size() + toRight.size();
+  if (!Trade(toLeft, toRight, received)) return false;
+
+  ghosts.clear();
+  for (const BoidRecord &record : received) {
+    ghosts.push_back(FromRecord(record, &_settings.params));
+  }
+  return true;
+}
+
+void DomainWorker::Evolve() {
+  // the same phases as Simulation::Step, over the own boids with the
+  // ghosts as extra neighbours
+  tree.clear();
+  for (Boid &boid : boids) tree.insert(&boid);
+  for (Boid &ghost : ghosts) tree.insert(&ghost);
+
+  obstaclePtrs.clear();
+  for (Obstacle &obs : obstacles) obstaclePtrs.push_back(&obs);
+
+  SteeringFunction rules = SelectSteering(_settings.weights,
+                                         _settings.completeEvasion, false);
+  steering.resize(boids.size());
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    Vec2 pos = boids[i].GetPosition();
+    neighbors.clear();
+    tree.query(Rect(pos.x - haloWidth, pos.y - haloWidth, 2 * haloWidth,
+                    2 * haloWidth),
+               neighbors);
+    if (_settings.deterministic) SortCanonical(neighbors);
+    steering[i] = rules(boids[i], {neighbors, obstaclePtrs, _settings.weights,
+                                   Vec2{}});
+  }
+
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    Integrate(boids[i], steering[i], _settings.width, _settings.height,
+              _settings.margin, _settings.step);
+  }
+
+  // order preserving removal of the destroyed boids
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    bool collided = false;
+    for (Obstacle &obstacle : obstacles) {
+      if (obstacle.CollisionResponse(boids[i], _settings.completeEvasion)) {
+        collided = true;
+        break;
+      }
+    }
+    if (collided && boids[i].UpdateHit(_settings.step)) continue;
+    if (kept != i) boids[kept] = std::move(boids[i]);
+    ++kept;
+  }
+  boids.erase(boids.begin() + static_cast<std::ptrdiff_t>(kept), boids.end());
+}
+
+bool DomainWorker::Migrate() {
+  int ranks = _settings.ranks;
+  toLeft.clear();
+  toRight.clear();
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    int owner = strips.OwnerOf(boids[i].GetPosition().x);
+    if (owner == _rank) {
+      if (kept != i) boids[kept] = std::move(boids[i]);
+      ++kept;
+    } else if (owner == (_rank + 1) % ranks) {
+      toRight.push_back(ToRecord(boids[i]));
+    } else {
+      assert(owner == (_rank + ranks - 1) % ranks &&
+             "boid moved past a whole strip in one step");
+      toLeft.push_back(ToRecord(boids[i]));
+    }
+  }
+  boids.erase(boids.begin() + static_cast<std::ptrdiff_t>(kept), boids.end());
+  stats.migrated += toLeft.size() + toRight.size();
+
+  if (!Trade(toLeft, toRight, received)) return false;
+  for (const BoidRecord &record : received) {
+    assert(strips.OwnerOf(record.position.x) == _rank);
+    AddBoid(record);
+  }
+  return true;
+}
+
+//------processes-------
+
+namespace {
+
+// body of a forked rank, the return value is its exit status
+int RunRank(const DomainSettings &settings, int rank,
+            const std::vector<BoidRecord> &initial,
+            const std::vector<Obstacle> &obstacles, Channel *left,
+            Channel *right, Channel &parent) {
+  StripDecomposition strips(settings.width, settings.ranks);
+  DomainWorker worker(settings, rank, left, right);
+  for (const BoidRecord &record : initial) {
+    if (strips.OwnerOf(record.position.x) == rank) worker.AddBoid(record);
+  }
+  for (const Obstacle &obstacle : obstacles) worker.AddObstacle(obstacle);
+
+  for (int i = 0; i < settings.steps; ++i) {
+    if (!worker.Step()) return 1;
+  }
+
+  std::vector<BoidRecord> records;
+  for (const Boid &boid : worker.GetBoids()) records.push_back(ToRecord(boid));
+  std::vector<char> message;
+  Pack(records, message);
+  if (!parent.Send(message)) return 1;
+  Pack(std::vector<DomainStats>{worker.GetStats()}, message);
+  return parent.Send(message) ? 0 : 1;
+}
+
+}  // namespace
+
+bool RunDistributed(const DomainSettings &settings,
+                    const std::vector<BoidRecord> &initial,
+                    const std::vector<Obstacle> &obstacles,
+                    std::vector<BoidRecord> &result,
+                    std::vector<DomainStats> *stats) {
+  assert(settings.ranks > 0 && settings.steps >= 0);
+  std::size_t ranks = static_cast<std::size_t>(settings.ranks);
+  float haloWidth = std::max({settings.params.separation,
+                              settings.params.cohesion,
+                              settings.params.alignment});
+  if (ranks > 1 && settings.width / static_cast<float>(ranks) < haloWidth) {
+    return false;  // strips narrower than the interaction range
+  }
+
+  // ring: the right end of rank i is connected to the left end of rank i+1
+  std::vector<Channel> lefts(ranks);
+  std::vector<Channel> rights(ranks);
+  std::vector<Channel> parents(ranks);
+  std::vector<Channel> children(ranks);
+  for (std::size_t i = 0; i < ranks; ++i) {
+    if (ranks > 1 && !Channel::CreatePair(rights[i], lefts[(i + 1) % ranks])) {
+      return false;
+    }
+    if (!Channel::CreatePair(parents[i], children[i])) return false;
+  }
+
+  std::vector<pid_t> pids;
+  bool ok = true;
+  for (std::size_t i = 0; i < ranks && ok; ++i) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      ok = false;
+    } else if (pid == 0) {
+      // the child keeps only its own ends, so a rank that dies shows up as
+      // a closed channel on its neighbours and on the parent
+      for (std::size_t j = 0; j < ranks; ++j) {
+        parents[j].Close();
+        if (j != i) {
+          lefts[j].Close();
+          rights[j].Close();
+          children[j].Close();
+        }
+      }
+      Channel *left = ranks > 1 ? &lefts[i] : nullptr;
+      Channel *right = ranks > 1 ? &rights[i] : nullptr;
+      _exit(RunRank(settings, static_cast<int>(i), initial, obstacles, left,
+                    right, children[i]));
+    } else {
+      pids.push_back(pid);
+    }
+  }
+  for (std::size_t i = 0; i < ranks; ++i) {
+    lefts[i].Close();
+    rights[i].Close();
+    children[i].Close();
+  }
+
+  result.clear();
+  if (stats != nullptr) stats->clear();
+  std::vector<char> message;
+  std::vector<BoidRecord> records;
+  std::vector<DomainStats> rankStats;
+  for (std::size_t i = 0; i < pids.size() && ok; ++i) {
+    ok = parents[i].Receive(message) && Unpack(message, records) &&
+         parents[i].Receive(message) && Unpack(message, rankStats) &&
+         rankStats.size() == 1;
+    if (!ok) break;
+    result.insert(result.end(), records.begin(), records.end());
+    if (stats != nullptr) stats->push_back(rankStats[0]);
+  }
+
+  // a failed rank closes its channels, which brings the others down too
+  for (Channel &parent : parents) parent.Close();
+  for (pid_t pid : pids) {
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+      if (errno != EINTR) {
+        ok = false;
+        break;
+      }
+    }
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  return ok;
+}
@@ -0,0 +1,123 @@
+#ifndef DOMAIN_HPP
+#define DOMAIN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "channel.hpp"
+#include "evolution.hpp"
+#include "quadtree.hpp"
+
+// what every rank of a distributed run simulates
+struct DomainSettings {
+  float width = 800.f;
+  float height = 600.f;
+  float margin = 5.f;  // wrap margin, as for Simulation
+  BehaviorWeights weights;
+  BoidParams params;
+  bool completeEvasion = false;
+  // canonical neighbour order, for results identical to a deterministic
+  // Simulation whatever the number of ranks
+  bool deterministic = false;
+  int ranks = 2;
+  int steps = 1200;
+  float step = kReferenceStep;
+};
+
+// boid state as it travels between processes
+struct BoidRecord {
+  Vec2 position;
+  Vec2 velocity;
+  float hitTimer = 1.f;
+  std::int32_t damage = 0;
+  std::uint8_t hit = 0;
+};
+
+BoidRecord ToRecord(const Boid &boid);
+Boid FromRecord(const BoidRecord &record, const BoidParams *params);
+
+// the world split into vertical strips of equal width, one per rank; the
+// first and last strips also own what lies in the wrap margins
+class StripDecomposition {
+ public:
+  StripDecomposition(float width, int ranks);
+
+  int GetRanks() const;
+  float GetLeft(int rank) const;
+  float GetRight(int rank) const;
+  int OwnerOf(float x) const;
+
+ private:
+  float _width;
+  int _ranks;
+};
+
+// per rank counters of a distributed run
+struct DomainStats {
+  std::uint64_t steps = 0;
+  std::uint64_t boids = 0;  // owned at the end
+  std::uint64_t haloSent = 0;
+  std::uint64_t migrated = 0;  // boids handed to a neighbour
+  std::uint64_t bytesSent = 0;
+  float seconds = 0.f;  // wall time of the steps
+};
+
+// one strip of the world; every step it trades halo boids with the ranks
+// on its left and right, evolves its own boids, then hands over the ones
+// that left the strip. Both channels are null for a single rank.
+class DomainWorker {
+ public:
+  DomainWorker(const DomainSettings &settings, int rank, Channel *left,
+               Channel *right);
+  DomainWorker(const DomainWorker &) = delete;
+  DomainWorker &operator=(const DomainWorker &) = delete;
+
+  void AddBoid(const BoidRecord &record);
+  void AddObstacle(const Obstacle &obstacle);
+  const std::vector<Boid> &GetBoids() const;
+  const DomainStats &GetStats() const;
+
+  // false when a neighbour went away
+  bool Step();
+
+ private:
+  bool ExchangeHalo();
+  void Evolve();
+  bool Migrate();
+  bool Trade(const std::vector<BoidRecord> &toLeft,
+             const std::vector<BoidRecord> &toRight,
+             std::vector<BoidRecord> &received);
+
+  DomainSettings _settings;
+  StripDecomposition strips;
+  int _rank;
+  Channel *_left;
+  Channel *_right;
+  float haloWidth;  // largest rule radius
+
+  std::vector<Boid> boids;
+  std::vector<Boid> ghosts;  // copies of the neighbours' boundary boids
+  std::vector<Obstacle> obstacles;
+  DomainStats stats;
+
+  //------per step scratch data-------
+  Quadtree tree;
+  std::vector<Obstacle *> obstaclePtrs;
+  std::vector<Vec2> steering;
+  std::vector<Boid *> neighbors;
+  std::vector<BoidRecord> toLeft;
+  std::vector<BoidRecord> toRight;
+  std::vector<BoidRecord> received;
+};
+
+// forks one process per rank, connected in a ring by socket pairs, hands
+// every initial boid to its owner and collects the final boids (grouped by
+// rank) and the stats of every rank; false if a rank failed
+bool RunDistributed(const DomainSettings &settings,
+                    const std::vector<BoidRecord> &initial,
+                    const std::vector<Obstacle> &obstacles,
+                    std::vector<BoidRecord> &result,
+                    std::vector<DomainStats> *stats = nullptr);
+
+#endif
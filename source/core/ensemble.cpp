@@ -0,0 +1,111 @@
+#include "ensemble.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+#include "counter_rng.hpp"
+
+void InitialState(const EnsembleSettings &settings,
+                  const EnsembleMember &member, std::vector<Vec2> &positions,
+                  std::vector<Vec2> &velocities) {
+  SpawnUniform(member.seed, 0, settings.boids,
+               {0.f, 0.f, settings.width, settings.height},
+               member.params.maxSpeed, positions, velocities);
+}
+
+EnsembleSummary RunMember(const EnsembleSettings &settings,
+                          const EnsembleMember &member) {
+  auto start = std::chrono::steady_clock::now();
+  const BoidParams &params = member.params;
+  Simulation simulation(settings.width, settings.height, params.radius,
+                        member.weights, params);
+
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  InitialState(settings, member, positions, velocities);
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    simulation.AddBoid(positions[i], velocities[i]);
+  }
+
+  for (int i = 0; i < settings.steps; ++i) simulation.Step(settings.step);
+
+  // --- order parameters of the final state ---
+  EnsembleSummary summary;
+  const std::vector<Boid> &boids = std::as_const(simulation).GetBoids();
+  summary.boids = boids.size();
+  if (!boids.empty()) {
+    Vec2 velocitySum;
+    float speedSum = 0.f;
+    for (const Boid &boid : boids) {
+      velocitySum += boid.GetVelocity();
+      speedSum += Norm(boid.GetVelocity());
+    }
+    float count = static_cast<float>(boids.size());
+    summary.meanSpeed = speedSum / count;
+    summary.polarization = speedSum > 0.f ? Norm(velocitySum) / speedSum : 0.f;
+
+    float coh2 = params.cohesion * params.cohesion;
+    std::size_t neighbors = 0;
+    std::vector<Boid *> found;
+    for (const Boid &boid : boids) {
+      Vec2 pos = boid.GetPosition();
+      found.clear();
+      simulation.QueryBoids(Rect(pos.x - params.cohesion,
+                                 pos.y - params.cohesion, 2 * params.cohesion,
+                                 2 * params.cohesion),
+                            found);
+      for (const Boid *other : found) {
+        if (other != &boid && DistSqr(other->GetPosition(), pos) <= coh2) {
+          ++neighbors;
+        }
+      }
+    }
+    summary.meanNeighbors = static_cast<float>(neighbors) / count;
+  }
+
+  summary.seconds = std::chrono::duration<float>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  return summary;
+}
+
+std::vector<EnsembleSummary> RunEnsemble(
+    const EnsembleSettings &settings,
+    const std::vector<EnsembleMember> &members, ThreadPool *pool) {
+  assert(settings.step > 0.f && settings.steps >= 0);
+  std::vector<EnsembleSummary> summaries(members.size());
+  auto run = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      summaries[i] = RunMember(settings, members[i]);
+    }
+  };
+
+  // members are independent, so each one is a task of its own; inside a
+  // member the step runs serially
+  if (pool != nullptr) {
+    pool->ParallelFor(members.size(), 1, run);
+  } else {
+    run(0, members.size());
+  }
+  return summaries;
+}
+
+void WriteSummaryTable(std::ostream &out,
+                       const std::vector<EnsembleMember> &members,
+                       const std::vector<EnsembleSummary> &summaries) {
+  assert(members.size() == summaries.size());
+  out << "member\tseed\tseparation\talignment\tcohesion\tradius\t"
+         "r_separation\tr_cohesion\tr_alignment\tboids\tmean_speed\t"
+         "polarization\tmean_neighbors\tseconds\n";
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    const EnsembleMember &m = members[i];
+    const EnsembleSummary &s = summaries[i];
+    out << i << '\t' << m.seed << '\t' << m.weights.separation << '\t'
+        << m.weights.alignment << '\t' << m.weights.cohesion << '\t'
+        << m.params.radius << '\t' << m.params.separation << '\t'
+        << m.params.cohesion << '\t' << m.params.alignment << '\t' << s.boids
+        << '\t' << s.meanSpeed << '\t' << s.polarization << '\t'
+        << s.meanNeighbors << '\t' << s.seconds << '\n';
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "simulation.hpp"
+
+// one configuration of a parameter sweep
+struct EnsembleMember {
+  BehaviorWeights weights;
+  BoidParams params;
+  std::uint32_t seed = 0;  // initial positions and velocities
+};
+
+// what every member of the ensemble runs
+struct EnsembleSettings {
+  float width = 800.f;
+  float height = 600.f;
+  std::size_t boids = 200;
+  int steps = 1200;  // ten seconds at the reference rate
+  float step = kReferenceStep;
+};
+
+// state of a member at the end of its run
+struct EnsembleSummary {
+  std::size_t boids = 0;
+  float meanSpeed = 0.f;
+  // length of the mean velocity over the mean speed, 1 for a fully aligned
+  // flock and close to 0 for a disordered one
+  float polarization = 0.f;
+  float meanNeighbors = 0.f;  // boids within the cohesion radius
+  float seconds = 0.f;        // wall time of the run
+};
+
+// random initial positions and velocities of a member, from its seed
+void InitialState(const EnsembleSettings &settings,
+                  const EnsembleMember &member, std::vector<Vec2> &positions,
+                  std::vector<Vec2> &velocities);
+
+// runs every member on its own simulation, one member per pool task; the
+// results do not depend on the pool
+EnsembleSummary RunMember(const EnsembleSettings &settings,
+                          const EnsembleMember &member);
+std::vector<EnsembleSummary> RunEnsemble(
+    const EnsembleSettings &settings,
+    const std::vector<EnsembleMember> &members, ThreadPool *pool);
+
+// tab separated table, one row per member
+void WriteSummaryTable(std::ostream &out,
+                       const std::vector<EnsembleMember> &members,
+                       const std::vector<EnsembleSummary> &summaries);
+
+#endif
@@ -0,0 +1,52 @@
+#include "evolution.hpp"
+
+#include <cassert>
+#include <cmath>
+
+Vec2 Steering(const Boid &boid, const std::vector<Boid *> &neighbors,
+              const std::vector<Obstacle *> &obstacles,
+              const BehaviorWeights &weights, bool completeEvasion,
+              bool mouseFollowMode, Vec2 mousePos) {
+  SteeringFunction steering =
+      SelectSteering(weights, completeEvasion, mouseFollowMode);
+  return steering(boid, {neighbors, obstacles, weights, mousePos});
+}
+
+void Integrate(Boid &boid, Vec2 steeringForce, float maxX, float maxY,
+               float Radius, float dt) {
+  assert(dt >= 0.f);
+
+  // position & velocity after update
+  Vec2 pos = boid.GetPosition();
+  Vec2 vel = boid.GetVelocity();
+
+  // apply complete steering, forces are per reference tick
+  float ticks = dt * kReferenceRate;
+  boid.SpeedChange(boid.GetVelocity() + steeringForce * ticks);
+  boid.Update_Position(dt);
+
+  assert(!std::isnan(pos.x) && !std::isnan(pos.y));
+  assert(!std::isnan(vel.x) && !std::isnan(vel.y));
+
+  //  Pac-Man wrapping effect at borders
+  if (pos.x > maxX + Radius) {
+    boid.SetPosition({-Radius, pos.y});
+  } else if (pos.x < -Radius) {
+    boid.SetPosition({maxX + Radius, pos.y});
+  }
+
+  if (pos.y > maxY + Radius) {
+    boid.SetPosition({pos.x, -Radius});
+  } else if (pos.y < -Radius) {
+    boid.SetPosition({pos.x, maxY + Radius});
+  }
+}
+
+void Evolution(Boid &boid, const std::vector<Boid *> &neighbors,
+               std::vector<Obstacle *> &obstacles, float &maxX, float &maxY,
+               float &Radius, const BehaviorWeights &weights, float dt,
+               bool completeEvasion, bool mouseFollowMode, Vec2 mousePos) {
+  Vec2 steeringForce = Steering(boid, neighbors, obstacles, weights,
+                                completeEvasion, mouseFollowMode, mousePos);
+  Integrate(boid, steeringForce, maxX, maxY, Radius, dt);
+}
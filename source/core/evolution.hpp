@@ -0,0 +1,32 @@
+#ifndef EVOLUTION_HPP
+#define EVOLUTION_HPP
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "steering_rules.hpp"
+
+// total steering force on a boid from its neighbours, the obstacles and the
+// arrow; it only reads the boids, so all of them can be evaluated in
+// parallel. It picks the rule set on every call: loops over many boids
+// should call SelectSteering once instead.
+Vec2 Steering(const Boid &boid, const std::vector<Boid *> &neighbors,
+              const std::vector<Obstacle *> &obstacles,
+              const BehaviorWeights &weights, bool completeEvasion = false,
+              bool mouseFollowMode = false, Vec2 mousePos = {0.f, 0.f});
+
+// applies a steering force to the boid for dt seconds and wraps it around
+// the borders of the world
+void Integrate(Boid &boid, Vec2 steeringForce, float maxX, float maxY,
+               float Radius, float dt);
+
+// this function manages the majority of the boid interactions, advancing the
+// boid by dt seconds (Steering followed by Integrate)
+void Evolution(Boid &boid, const std::vector<Boid *> &neighbors,
+               std::vector<Obstacle *> &obstacles, float &maxX, float &maxY,
+               float &Radius, const BehaviorWeights &weights, float dt,
+               bool completeEvasion = false, bool mouseFollowMode = false,
+               Vec2 mousePos = {0.f, 0.f});
+
+#endif
@@ -0,0 +1,273 @@
+#include "fixed_flock.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+// floor(sqrt(n)): the floating point guess is corrected with exact integer
+// steps, so the result does not depend on how the guess was rounded
+std::uint64_t ISqrt(std::uint64_t n) {
+  auto root = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(n)));
+  root = std::min<std::uint64_t>(root, 0xffffffff);
+  while (root * root > n) --root;
+  while (root < 0xffffffff && (root + 1) * (root + 1) <= n) ++root;
+  return root;
+}
+
+// direction of (x, y) as a vector of length 1 << unitBits, (0, 0) stays
+void Unit(std::int64_t x, std::int64_t y, int unitBits, std::int64_t &ux,
+          std::int64_t &uy) {
+  // the direction survives dropping low bits, the squares must fit
+  while (x >= (1LL << 31) || x <= -(1LL << 31) || y >= (1LL << 31) ||
+         y <= -(1LL << 31)) {
+    x >>= 1;
+    y >>= 1;
+  }
+  auto n2 =
+      static_cast<std::uint64_t>(x * x) + static_cast<std::uint64_t>(y * y);
+  auto norm = static_cast<std::int64_t>(ISqrt(n2));
+  if (norm == 0) {
+    ux = uy = 0;
+    return;
+  }
+  ux = x * (1LL << unitBits) / norm;
+  uy = y * (1LL << unitBits) / norm;
+}
+
+std::int64_t Weighted(std::int64_t weight, std::int64_t force, int bits) {
+  return (weight * force) >> bits;  // arithmetic shift, rounds down
+}
+
+}  // namespace
+
+FixedFlock::FixedFlock(int worldBits, const BehaviorWeights &weights,
+                       const BoidParams &params)
+    : fracBits(32 - worldBits) {
+  // directions are widened to velocities by a left shift
+  assert(worldBits >= 1 && fracBits >= unitBits);
+  assert(weights.separation < 64.f && weights.alignment < 64.f &&
+         weights.cohesion < 64.f);
+
+  auto weight = [](float value) {
+    return static_cast<std::int64_t>(
+        std::llround(std::ldexp(static_cast<double>(value), weightBits)));
+  };
+  separationWeight = weight(weights.separation);
+  alignmentWeight = weight(weights.alignment);
+  cohesionWeight = weight(weights.cohesion);
+
+  auto squared = [this](float radius) {
+    auto r = static_cast<std::uint64_t>(ToFixed(radius));
+    return r * r;
+  };
+  separation2 = squared(params.separation);
+  cohesion2 = squared(params.cohesion);
+  alignment2 = squared(params.alignment);
+  maxSpeed = ToFixed(params.maxSpeed);
+
+  // cells of 2^(worldBits - cellBits) units; with fewer than 4 cells per
+  // side the 3x3 neighbourhood would visit a cell twice, so one cell it is
+  float maxRadius =
+      std::max({params.separation, params.cohesion, params.alignment});
+  int radiusBits = 0;  // exact, unlike a library log2
+  while (std::ldexp(1.f, radiusBits) < maxRadius) ++radiusBits;
+  cellBits = worldBits - radiusBits;
+  cellBits = std::min(cellBits, 8);
+  if (cellBits < 2) cellBits = 0;
+}
+
+std::int64_t FixedFlock::ToFixed(float value) const {
+  return static_cast<std::int64_t>(
+      std::llround(std::ldexp(static_cast<double>(value), fracBits)));
+}
+
+float FixedFlock::GetWorldSize() const {
+  return std::ldexp(1.f, 32 - fracBits);
+}
+std::size_t FixedFlock::GetBoidCount() const { return posX.size(); }
+
+void FixedFlock::AddBoid(Vec2 position, Vec2 velocity) {
+  // two's complement wrap onto the torus
+  posX.push_back(static_cast<std::uint32_t>(ToFixed(position.x)));
+  posY.push_back(static_cast<std::uint32_t>(ToFixed(position.y)));
+  velX.push_back(static_cast<std::int32_t>(ToFixed(velocity.x)));
+  velY.push_back(static_cast<std::int32_t>(ToFixed(velocity.y)));
+}
+
+Vec2 FixedFlock::GetPosition(std::size_t boid) const {
+  return {std::ldexp(static_cast<float>(posX[boid]), -fracBits),
+          std::ldexp(static_cast<float>(posY[boid]), -fracBits)};
+}
+Vec2 FixedFlock::GetVelocity(std::size_t boid) const {
+  return {std::ldexp(static_cast<float>(velX[boid]), -fracBits),
+          std::ldexp(static_cast<float>(velY[boid]), -fracBits)};
+}
+
+std::uint64_t FixedFlock::Checksum() const {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  auto mix = [&hash](std::uint32_t word) {
+    for (int byte = 0; byte < 4; ++byte) {
+      hash ^= (word >> (8 * byte)) & 0xff;
+      hash *= 0x100000001b3;
+    }
+  };
+  for (std::size_t i = 0; i < posX.size(); ++i) {
+    mix(posX[i]);
+    mix(posY[i]);
+    mix(static_cast<std::uint32_t>(velX[i]));
+    mix(static_cast<std::uint32_t>(velY[i]));
+  }
+  return hash;
+}
+
+void FixedFlock::SetThreadPool(ThreadPool *pool) { _pool = pool; }
+
+void FixedFlock::Step() {
+  BuildCells();
+  newVX.resize(posX.size());
+  newVY.resize(posX.size());
+  if (_pool != nullptr) {
+    _pool->ParallelFor(posX.size(), grain,
+                       [this](std::size_t begin, std::size_t end) {
+                         EvaluateRules(begin, end);
+                       });
+  } else {
+    EvaluateRules(0, posX.size());
+  }
+
+  // everyone moves after all of them steered; the borders wrap by overflow
+  velX.swap(newVX);
+  velY.swap(newVY);
+  for (std::size_t i = 0; i < posX.size(); ++i) {
+    posX[i] += static_cast<std::uint32_t>(velX[i]);
+    posY[i] += static_cast<std::uint32_t>(velY[i]);
+  }
+}
+
+void FixedFlock::BuildCells() {
+  // counting sort of the boids by cell, with copies of their state in that
+  // order so a neighbourhood is read from a few contiguous runs
+  std::size_t count = posX.size();
+  std::size_t cells = std::size_t{1} << (2 * cellBits);
+  int shift = 32 - cellBits;
+  cellStart.assign(cells + 1, 0);
+  cellOf.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    std::uint32_t cell = 0;
+    if (cellBits > 0)
+      cell = (posY[i] >> shift << cellBits) | (posX[i] >> shift);
+    cellOf[i] = cell;
+    ++cellStart[cell + 1];
+  }
+  for (std::size_t c = 0; c < cells; ++c) cellStart[c + 1] += cellStart[c];
+
+  order.resize(count);
+  sortedX.resize(count);
+  sortedY.resize(count);
+  sortedVX.resize(count);
+  sortedVY.resize(count);
+  std::vector<std::uint32_t> next(cellStart.begin(), cellStart.end() - 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    std::uint32_t slot = next[cellOf[i]]++;
+    order[slot] = static_cast<std::uint32_t>(i);
+    sortedX[slot] = posX[i];
+    sortedY[slot] = posY[i];
+    sortedVX[slot] = velX[i];
+    sortedVY[slot] = velY[i];
+  }
+}
+
+void FixedFlock::EvaluateRules(std::size_t begin, std::size_t end) {
+  std::uint32_t mask = (1u << cellBits) - 1;
+  int reach = cellBits > 0 ? 1 : 0;
+  int toVelocity = fracBits - unitBits;
+
+  for (std::size_t i = begin; i < end; ++i) {
+    std::uint32_t px = posX[i];
+    std::uint32_t py = posY[i];
+    std::int64_t sepX = 0, sepY = 0;
+    std::int64_t cohX = 0, cohY = 0, cohN = 0;
+    std::int64_t alnX = 0, alnY = 0, alnN = 0;
+
+    std::uint32_t cx = cellOf[i] & mask;
+    std::uint32_t cy = cellOf[i] >> cellBits;
+    for (int oy = -reach; oy <= reach; ++oy) {
+      for (int ox = -reach; ox <= reach; ++ox) {
+        std::uint32_t cell =
+            ((cy + static_cast<std::uint32_t>(oy)) & mask) << cellBits |
+            ((cx + static_cast<std::uint32_t>(ox)) & mask);
+        for (std::uint32_t s = cellStart[cell]; s < cellStart[cell + 1]; ++s) {
+          if (order[s] == i) continue;
+          // shortest way around the torus
+          auto dx = static_cast<std::int32_t>(sortedX[s] - px);
+          auto dy = static_cast<std::int32_t>(sortedY[s] - py);
+          std::uint64_t d2 =
+              static_cast<std::uint64_t>(std::int64_t{dx} * dx) +
+              static_cast<std::uint64_t>(std::int64_t{dy} * dy);
+
+          if (d2 <= separation2 && d2 > 0) {
+            std::int64_t ux, uy;
+            Unit(-std::int64_t{dx}, -std::int64_t{dy}, unitBits, ux, uy);
+            sepX += ux;
+            sepY += uy;
+          }
+          if (d2 <= cohesion2) {
+            cohX += dx;
+            cohY += dy;
+            ++cohN;
+          }
+          if (d2 <= alignment2) {
+            alnX += sortedVX[s];
+            alnY += sortedVY[s];
+            ++alnN;
+          }
+        }
+      }
+    }
+
+    // same rules as flock.cpp: unit of the summed repulsions, unit towards
+    // the mean position and unit along the mean velocity, the last two
+    // minus the own velocity; directions become velocities of one unit
+    std::int64_t vx = velX[i];
+    std::int64_t vy = velY[i];
+    std::int64_t ux, uy;
+    Unit(sepX, sepY, unitBits, ux, uy);
+    std::int64_t steerX =
+        Weighted(separationWeight, ux << toVelocity, weightBits);
+    std::int64_t steerY =
+        Weighted(separationWeight, uy << toVelocity, weightBits);
+    if (cohN > 0) {
+      Unit(cohX / cohN, cohY / cohN, unitBits, ux, uy);
+      if (ux != 0 || uy != 0) {
+        steerX +=
+            Weighted(cohesionWeight, (ux << toVelocity) - vx, weightBits);
+        steerY +=
+            Weighted(cohesionWeight, (uy << toVelocity) - vy, weightBits);
+      }
+    }
+    if (alnN > 0) {
+      Unit(alnX / alnN, alnY / alnN, unitBits, ux, uy);
+      if (ux != 0 || uy != 0) {
+        steerX +=
+            Weighted(alignmentWeight, (ux << toVelocity) - vx, weightBits);
+        steerY +=
+            Weighted(alignmentWeight, (uy << toVelocity) - vy, weightBits);
+      }
+    }
+
+    // speed limit, as Boid::SpeedChange
+    vx += steerX;
+    vy += steerY;
+    auto speed = static_cast<std::int64_t>(
+        ISqrt(static_cast<std::uint64_t>(vx * vx) +
+              static_cast<std::uint64_t>(vy * vy)));
+    if (speed > maxSpeed) {
+      vx = vx * maxSpeed / speed;
+      vy = vy * maxSpeed / speed;
+    }
+    newVX[i] = static_cast<std::int32_t>(vx);
+    newVY[i] = static_cast<std::int32_t>(vy);
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef FIXED_FLOCK_HPP
+#define FIXED_FLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "evolution.hpp"
+#include "thread_pool.hpp"
+
+// the flocking rules on fixed-point integers, for runs that must give the
+// same bits on every compiler, flag set and machine. The world is a square
+// torus of 2^worldBits units: a coordinate is an unsigned 32 bit integer
+// with 32 - worldBits fractional bits, so moving across a border is plain
+// unsigned overflow and the difference of two coordinates, read as signed,
+// is the shortest way around. Integer sums do not depend on their order, so
+// neither the neighbour order nor the pool changes the result.
+// No obstacles, no arrow following; one Step() is one reference tick.
+class FixedFlock {
+ public:
+  FixedFlock(int worldBits, const BehaviorWeights &weights,
+             const BoidParams &params = BoidParams{});
+
+  float GetWorldSize() const;
+  std::size_t GetBoidCount() const;
+  // positions are wrapped onto the torus and rounded to the grid
+  void AddBoid(Vec2 position, Vec2 velocity);
+  Vec2 GetPosition(std::size_t boid) const;
+  Vec2 GetVelocity(std::size_t boid) const;
+  // FNV-1a of the whole state, to compare runs across machines
+  std::uint64_t Checksum() const;
+
+  void SetThreadPool(ThreadPool *pool);
+  void Step();
+
+ private:
+  void BuildCells();
+  void EvaluateRules(std::size_t begin, std::size_t end);
+  std::int64_t ToFixed(float value) const;
+
+  static constexpr int unitBits = 16;    // directions, |v| = 1 << unitBits
+  static constexpr int weightBits = 24;  // rule weights
+  static constexpr std::size_t grain = 1024;
+
+  int fracBits;
+  int cellBits;  // 2^cellBits cells per side, each wider than any radius
+  std::int64_t separationWeight, alignmentWeight, cohesionWeight;
+  std::uint64_t separation2, cohesion2, alignment2;
+  std::int64_t maxSpeed;
+  ThreadPool *_pool = nullptr;
+
+  //------boid state-------
+  std::vector<std::uint32_t> posX, posY;
+  std::vector<std::int32_t> velX, velY;
+
+  //------per step scratch data, boids sorted by cell-------
+  std::vector<std::uint32_t> cellStart;
+  std::vector<std::uint32_t> order;
+  std::vector<std::uint32_t> cellOf;
+  std::vector<std::uint32_t> sortedX, sortedY;
+  std::vector<std::int32_t> sortedVX, sortedVY;
+  std::vector<std::int32_t> newVX, newVY;
+};
+
+#endif
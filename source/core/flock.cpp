@@ -0,0 +1,78 @@
+#include "flock.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+
+//------accelerations list-------
+
+Vec2 SepSpeed(const Boid *boid1, const std::vector<Boid *> &boid_list) {
+  float sep2 = boid1->GetRadiusSep() * boid1->GetRadiusSep();
+  Vec2 pos = boid1->GetPosition();
+  Vec2 diff{0.f, 0.f};
+
+  for (Boid *boid0 : boid_list) {
+    Vec2 away = pos - boid0->GetPosition();
+    float d2 = NormSqr(away);
+    if (boid0 != boid1 && d2 <= sep2 && d2 != 0) {
+      diff += Normalized(away, d2);
+    }
+  }
+  return (diff != Vec2{0.f, 0.f}) ? Normalized(diff) : Vec2{0.f, 0.f};
+}
+
+Vec2 CohSpeed(const Boid *boid, const std::vector<Boid *> &boid_list) {
+  float coh2 = boid->GetRadiusCoh() * boid->GetRadiusCoh();
+  Vec2 pos = boid->GetPosition();
+  Vec2 sum_p{0.f, 0.f};
+  int counter = 0;
+  for (const Boid *boid0 : boid_list) {
+    if (boid0 != boid && DistSqr(boid0->GetPosition(), pos) <= coh2) {
+      sum_p += boid0->GetPosition();
+      counter++;
+    }
+  }
+  if (counter == 0) return {0.f, 0.f};
+
+  Vec2 vcoh = (sum_p / static_cast<float>(counter)) - pos;
+  float n2 = NormSqr(vcoh);
+  return (n2 != 0) ? Normalized(vcoh, n2) - boid->GetVelocity()
+                   : Vec2{0.f, 0.f};
+}
+
+Vec2 AlnSpeed(const Boid *boid1, const std::vector<Boid *> &boid_list) {
+  float alg2 = boid1->GetRadiusAlg() * boid1->GetRadiusAlg();
+  Vec2 pos = boid1->GetPosition();
+  Vec2 sum_v{0.f, 0.f};
+  int counter = 0;
+  for (const Boid *boid0 : boid_list) {
+    if (boid0 != boid1 && DistSqr(boid0->GetPosition(), pos) <= alg2) {
+      sum_v += boid0->GetVelocity();
+      counter++;
+    }
+  }
+  if (counter == 0) return {0.f, 0.f};
+
+  Vec2 valg = (sum_v / static_cast<float>(counter));
+  float n2 = NormSqr(valg);
+  return (n2 != 0) ? Normalized(valg, n2) - boid1->GetVelocity()
+                   : Vec2{0.f, 0.f};
+}
+
+//------canonical order-------
+
+bool CanonicalLess(const Boid *boid1, const Boid *boid2) {
+  Vec2 p1 = boid1->GetPosition();
+  Vec2 p2 = boid2->GetPosition();
+  if (p1.x != p2.x) return p1.x < p2.x;
+  if (p1.y != p2.y) return p1.y < p2.y;
+  Vec2 v1 = boid1->GetVelocity();
+  Vec2 v2 = boid2->GetVelocity();
+  if (v1.x != v2.x) return v1.x < v2.x;
+  return v1.y < v2.y;  // equal keys give equal contributions
+}
+
+void SortCanonical(std::vector<Boid *> &boid_list) {
+  std::sort(boid_list.begin(), boid_list.end(), CanonicalLess);
+}
@@ -0,0 +1,20 @@
+#ifndef FLOCK_HPP
+#define FLOCK_HPP
+
+#include <vector>
+
+#include "boid.hpp"
+
+//---- accelerations list------
+Vec2 SepSpeed(const Boid *boid1, const std::vector<Boid *> &boid_list);
+Vec2 AlnSpeed(const Boid *boid2, const std::vector<Boid *> &boid_list);
+Vec2 CohSpeed(const Boid *boid1, const std::vector<Boid *> &boid_list);
+
+//---- canonical neighbour order------
+// by position, then velocity: the sums above only read these, so sorted
+// lists give bit-identical results whatever the storage order of the boids,
+// the shape of the index or the way the world is split up
+bool CanonicalLess(const Boid *boid1, const Boid *boid2);
+void SortCanonical(std::vector<Boid *> &boid_list);
+
+#endif
\ No newline at end of file
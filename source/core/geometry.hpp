@@ -0,0 +1,123 @@
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
+// graphics-free 2D types of the simulation core, the rendering layer converts
+// them to the SFML equivalents only when drawing
+
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+struct Vec2 {
+  float x = 0.f;
+  float y = 0.f;
+
+  constexpr Vec2() = default;
+  constexpr Vec2(float px, float py) : x{px}, y{py} {}
+
+  constexpr Vec2 &operator+=(Vec2 other) {
+    x += other.x;
+    y += other.y;
+    return *this;
+  }
+  constexpr Vec2 &operator-=(Vec2 other) {
+    x -= other.x;
+    y -= other.y;
+    return *this;
+  }
+  constexpr Vec2 &operator*=(float factor) {
+    x *= factor;
+    y *= factor;
+    return *this;
+  }
+  constexpr Vec2 &operator/=(float factor) {
+    x /= factor;
+    y /= factor;
+    return *this;
+  }
+};
+
+constexpr Vec2 operator+(Vec2 a, Vec2 b) { return {a.x + b.x, a.y + b.y}; }
+constexpr Vec2 operator-(Vec2 a, Vec2 b) { return {a.x - b.x, a.y - b.y}; }
+constexpr Vec2 operator-(Vec2 a) { return {-a.x, -a.y}; }
+constexpr Vec2 operator*(Vec2 a, float k) { return {a.x * k, a.y * k}; }
+constexpr Vec2 operator*(float k, Vec2 a) { return {a.x * k, a.y * k}; }
+constexpr Vec2 operator/(Vec2 a, float k) { return {a.x / k, a.y / k}; }
+constexpr bool operator==(Vec2 a, Vec2 b) { return a.x == b.x && a.y == b.y; }
+constexpr bool operator!=(Vec2 a, Vec2 b) { return !(a == b); }
+
+//------vector math-------
+// inline, so the rule loops do not pay a call per neighbour
+
+constexpr float operator*(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+constexpr float NormSqr(Vec2 vec) { return vec * vec; }
+constexpr float DistSqr(Vec2 a, Vec2 b) { return (b - a) * (b - a); }
+
+constexpr float Norm(Vec2 vec) {
+  if (std::is_constant_evaluated()) {
+    // Newton's method, std::sqrt is not constexpr yet
+    double n2 = NormSqr(vec);
+    double root = n2 > 1. ? n2 : 1.;
+    for (int i = 0; i < 64 && n2 > 0.; ++i) root = (root + n2 / root) / 2.;
+    return n2 > 0. ? static_cast<float>(root) : 0.f;
+  }
+  assert(!std::isnan(vec.x) && !std::isnan(vec.y));
+  return std::sqrt(NormSqr(vec));
+}
+
+// 1/sqrt(x), x > 0: the hardware estimate refined by one Newton step,
+// within about 3e-7 of the exact value (the exact value where there is no
+// estimate instruction)
+inline float RSqrtFast(float x) {
+#if defined(__SSE__)
+  float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+  return y * (1.5f - 0.5f * x * y * y);
+#else
+  return 1.f / std::sqrt(x);
+#endif
+}
+
+// vec / |vec| for a non-zero vec whose squared norm is normSqr; built with
+// BOID_FAST_RSQRT it multiplies by RSqrtFast instead of dividing by sqrt
+inline Vec2 Normalized(Vec2 vec, float normSqr) {
+  assert(normSqr > 0.f);
+#if defined(BOID_FAST_RSQRT)
+  return vec * RSqrtFast(normSqr);
+#else
+  return vec / std::sqrt(normSqr);
+#endif
+}
+inline Vec2 Normalized(Vec2 vec) { return Normalized(vec, NormSqr(vec)); }
+
+// axis aligned rectangle, same half-open conventions as sf::FloatRect
+struct Rect {
+  float left = 0.f;
+  float top = 0.f;
+  float width = 0.f;
+  float height = 0.f;
+
+  constexpr Rect() = default;
+  constexpr Rect(float l, float t, float w, float h)
+      : left{l}, top{t}, width{w}, height{h} {}
+
+  constexpr bool contains(Vec2 point) const {
+    return point.x >= left && point.x < left + width && point.y >= top &&
+           point.y < top + height;
+  }
+  constexpr bool intersects(const Rect &other) const {
+    float interLeft = left > other.left ? left : other.left;
+    float interTop = top > other.top ? top : other.top;
+    float interRight = left + width < other.left + other.width
+                           ? left + width
+                           : other.left + other.width;
+    float interBottom = top + height < other.top + other.height
+                            ? top + height
+                            : other.top + other.height;
+    return interLeft < interRight && interTop < interBottom;
+  }
+};
+
+#endif
@@ -0,0 +1,288 @@
+#include "lane_ensemble.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+LaneEnsemble::LaneEnsemble(const EnsembleSettings &settings,
+                           const std::vector<EnsembleMember> &members)
+    : maxX(settings.width),
+      maxY(settings.height),
+      worlds(members.size()),
+      boids(settings.boids),
+      stride((members.size() + laneWidth - 1) / laneWidth * laneWidth) {
+  assert(!members.empty());
+
+  for (auto *lanes : {&separationWeight, &alignmentWeight, &cohesionWeight,
+                      &separation2, &cohesion2, &alignment2, &maxSpeed,
+                      &margin}) {
+    lanes->assign(stride, 0.f);
+  }
+  for (std::size_t w = 0; w < worlds; ++w) {
+    const BoidParams &params = members[w].params;
+    separationWeight[w] = members[w].weights.separation;
+    alignmentWeight[w] = members[w].weights.alignment;
+    cohesionWeight[w] = members[w].weights.cohesion;
+    separation2[w] = params.separation * params.separation;
+    cohesion2[w] = params.cohesion * params.cohesion;
+    alignment2[w] = params.alignment * params.alignment;
+    maxSpeed[w] = params.maxSpeed;
+    margin[w] = params.radius;
+  }
+
+  for (auto *state : {&posX, &posY, &velX, &velY, &steerX, &steerY}) {
+    state->assign(boids * stride, 0.f);
+  }
+
+  // same initial state as the member would get from RunMember
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  for (std::size_t w = 0; w < worlds; ++w) {
+    InitialState(settings, members[w], positions, velocities);
+    for (std::size_t b = 0; b < boids; ++b) {
+      posX[Index(b, w)] = positions[b].x;
+      posY[Index(b, w)] = positions[b].y;
+      velX[Index(b, w)] = velocities[b].x;
+      velY[Index(b, w)] = velocities[b].y;
+    }
+  }
+}
+
+std::size_t LaneEnsemble::GetWorldCount() const { return worlds; }
+std::size_t LaneEnsemble::GetBoidCount() const { return boids; }
+Vec2 LaneEnsemble::GetPosition(std::size_t world, std::size_t boid) const {
+  return {posX[Index(boid, world)], posY[Index(boid, world)]};
+}
+Vec2 LaneEnsemble::GetVelocity(std::size_t world, std::size_t boid) const {
+  return {velX[Index(boid, world)], velY[Index(boid, world)]};
+}
+
+std::size_t LaneEnsemble::Index(std::size_t boid, std::size_t world) const {
+  return boid * stride + world;
+}
+
+void LaneEnsemble::Step(float dt) {
+  // all steering is evaluated on the previous state before anyone moves
+  for (std::size_t first = 0; first < stride; first += laneWidth) {
+    for (std::size_t i = 0; i < boids; ++i) EvaluateRules(i, first);
+  }
+  Integrate(dt);
+}
+
+// The lane loops below are written for the auto-vectorizer: they run over a
+// fixed laneWidth, accumulate into local arrays (which nothing can alias),
+// every test is a chain of selects between plain values (a compound
+// condition would become a branch) and no lane divides by zero, so the
+// quotients are computed for all lanes and dropped where they do not apply.
+
+void LaneEnsemble::EvaluateRules(std::size_t i, std::size_t firstLane) {
+  constexpr std::size_t L = laneWidth;
+  const float *px = &posX[Index(i, firstLane)];
+  const float *py = &posY[Index(i, firstLane)];
+  const float *vx = &velX[Index(i, firstLane)];
+  const float *vy = &velY[Index(i, firstLane)];
+  const float *sep2 = &separation2[firstLane];
+  const float *coh2 = &cohesion2[firstLane];
+  const float *aln2 = &alignment2[firstLane];
+  const float width = maxX;
+  const float height = maxY;
+
+  float sepX[L] = {}, sepY[L] = {};
+  float cohX[L] = {}, cohY[L] = {}, cohN[L] = {};
+  float alnX[L] = {}, alnY[L] = {}, alnN[L] = {};
+
+  for (std::size_t j = 0; j < boids; ++j) {
+    if (j == i) continue;
+    const float *qx = &posX[Index(j, firstLane)];
+    const float *qy = &posY[Index(j, firstLane)];
+    const float *ux = &velX[Index(j, firstLane)];
+    const float *uy = &velY[Index(j, firstLane)];
+    for (std::size_t w = 0; w < L; ++w) {
+      float dx = qx[w] - px[w];
+      float dy = qy[w] - py[w];
+      float d2 = dx * dx + dy * dy;
+
+      // boids in the wrap margin are outside the quadtree of a Simulation,
+      // hence invisible to the others
+      float inside = qx[w] >= 0.f ? 1.f : 0.f;
+      inside = qx[w] < width ? inside : 0.f;
+      inside = qy[w] >= 0.f ? inside : 0.f;
+      inside = qy[w] < height ? inside : 0.f;
+
+      // neighbours on top of the boid give no direction to move away
+      float inSep = d2 <= sep2[w] ? inside : 0.f;
+      inSep = d2 > 0.f ? inSep : 0.f;
+      float invD = inSep / std::sqrt(d2 + (1.f - inSep));
+      sepX[w] -= dx * invD;
+      sepY[w] -= dy * invD;
+
+      float inCoh = d2 <= coh2[w] ? inside : 0.f;
+      cohX[w] += qx[w] * inCoh;
+      cohY[w] += qy[w] * inCoh;
+      cohN[w] += inCoh;
+
+      float inAln = d2 <= aln2[w] ? inside : 0.f;
+      alnX[w] += ux[w] * inAln;
+      alnY[w] += uy[w] * inAln;
+      alnN[w] += inAln;
+    }
+  }
+
+  const float *wSep = &separationWeight[firstLane];
+  const float *wAln = &alignmentWeight[firstLane];
+  const float *wCoh = &cohesionWeight[firstLane];
+  float steerXs[L], steerYs[L];
+  for (std::size_t w = 0; w < L; ++w) {
+    // separation: unit vector of the summed repulsions
+    float sepNorm = std::sqrt(sepX[w] * sepX[w] + sepY[w] * sepY[w]);
+    float sepScale = 1.f / (sepNorm > tiny ? sepNorm : tiny);
+    sepScale = sepNorm > 0.f ? sepScale : 0.f;
+
+    // cohesion: unit vector to the centre of mass, minus own velocity
+    float cx = cohX[w] / (cohN[w] > 1.f ? cohN[w] : 1.f) - px[w];
+    float cy = cohY[w] / (cohN[w] > 1.f ? cohN[w] : 1.f) - py[w];
+    float cohNorm = std::sqrt(cx * cx + cy * cy);
+    float cohOn = cohN[w] > 0.f ? 1.f : 0.f;
+    cohOn = cohNorm > 0.f ? cohOn : 0.f;
+    float cohScale = cohOn / (cohNorm > tiny ? cohNorm : tiny);
+
+    // alignment: unit mean velocity, minus own velocity
+    float ax = alnX[w] / (alnN[w] > 1.f ? alnN[w] : 1.f);
+    float ay = alnY[w] / (alnN[w] > 1.f ? alnN[w] : 1.f);
+    float alnNorm = std::sqrt(ax * ax + ay * ay);
+    float alnOn = alnN[w] > 0.f ? 1.f : 0.f;
+    alnOn = alnNorm > 0.f ? alnOn : 0.f;
+    float alnScale = alnOn / (alnNorm > tiny ? alnNorm : tiny);
+
+    steerXs[w] = wSep[w] * (sepX[w] * sepScale) +
+                 wAln[w] * (ax * alnScale - vx[w] * alnOn) +
+                 wCoh[w] * (cx * cohScale - vx[w] * cohOn);
+    steerYs[w] = wSep[w] * (sepY[w] * sepScale) +
+                 wAln[w] * (ay * alnScale - vy[w] * alnOn) +
+                 wCoh[w] * (cy * cohScale - vy[w] * cohOn);
+  }
+  std::copy_n(steerXs, L, &steerX[Index(i, firstLane)]);
+  std::copy_n(steerYs, L, &steerY[Index(i, firstLane)]);
+}
+
+void LaneEnsemble::Integrate(float dt) {
+  constexpr std::size_t L = laneWidth;
+  const float ticks = dt * kReferenceRate;
+  const float width = maxX;
+  const float height = maxY;
+  for (std::size_t b = 0; b < boids; ++b) {
+    for (std::size_t first = 0; first < stride; first += L) {
+      const float *limit = &maxSpeed[first];
+      const float *margins = &margin[first];
+      const float *sx = &steerX[Index(b, first)];
+      const float *sy = &steerY[Index(b, first)];
+      float *px = &posX[Index(b, first)];
+      float *py = &posY[Index(b, first)];
+      float *vx = &velX[Index(b, first)];
+      float *vy = &velY[Index(b, first)];
+
+      float x[L], y[L], ux[L], uy[L];
+      for (std::size_t w = 0; w < L; ++w) {
+        // speed limit as in Boid::SpeedChange
+        float nx = vx[w] + sx[w] * ticks;
+        float ny = vy[w] + sy[w] * ticks;
+        float speed = std::sqrt(nx * nx + ny * ny);
+        float safe = speed > tiny ? speed : tiny;
+        ux[w] = speed > limit[w] ? nx / safe * limit[w] : nx;
+        uy[w] = speed > limit[w] ? ny / safe * limit[w] : ny;
+
+        // wrapping decided on the position before the move, as in
+        // Integrate: a wrap in one direction keeps the old coordinate in
+        // the other one
+        float ox = px[w];
+        float oy = py[w];
+        float r = margins[w];
+        float nxp = ox + ux[w] * ticks;
+        float nyp = oy + uy[w] * ticks;
+        nyp = ox > width + r ? oy : nyp;
+        nyp = ox < -r ? oy : nyp;
+        nxp = ox > width + r ? -r : nxp;
+        nxp = ox < -r ? width + r : nxp;
+        nxp = oy > height + r ? ox : nxp;
+        nxp = oy < -r ? ox : nxp;
+        nyp = oy > height + r ? -r : nyp;
+        nyp = oy < -r ? height + r : nyp;
+        x[w] = nxp;
+        y[w] = nyp;
+      }
+      std::copy_n(x, L, px);
+      std::copy_n(y, L, py);
+      std::copy_n(ux, L, vx);
+      std::copy_n(uy, L, vy);
+    }
+  }
+}
+
+EnsembleSummary LaneEnsemble::Summarize(std::size_t world) const {
+  assert(world < worlds);
+  EnsembleSummary summary;
+  summary.boids = boids;
+  if (boids == 0) return summary;
+
+  Vec2 velocitySum;
+  float speedSum = 0.f;
+  std::size_t neighbors = 0;
+  Rect bounds(0.f, 0.f, maxX, maxY);  // what the quadtree would hold
+  for (std::size_t i = 0; i < boids; ++i) {
+    Vec2 velocity = GetVelocity(world, i);
+    velocitySum += velocity;
+    speedSum += Norm(velocity);
+    for (std::size_t j = 0; j < boids; ++j) {
+      Vec2 other = GetPosition(world, j);
+      if (j != i && bounds.contains(other) &&
+          DistSqr(GetPosition(world, i), other) <= cohesion2[world]) {
+        ++neighbors;
+      }
+    }
+  }
+  float count = static_cast<float>(boids);
+  summary.meanSpeed = speedSum / count;
+  summary.polarization = speedSum > 0.f ? Norm(velocitySum) / speedSum : 0.f;
+  summary.meanNeighbors = static_cast<float>(neighbors) / count;
+  return summary;
+}
+
+std::vector<EnsembleSummary> RunLaneEnsemble(
+    const EnsembleSettings &settings,
+    const std::vector<EnsembleMember> &members, ThreadPool *pool,
+    std::size_t lanesPerBlock) {
+  assert(settings.step > 0.f && settings.steps >= 0 && lanesPerBlock > 0);
+  std::vector<EnsembleSummary> summaries(members.size());
+
+  auto run = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t first = begin * lanesPerBlock;
+         first < std::min(end * lanesPerBlock, members.size());
+         first += lanesPerBlock) {
+      auto start = std::chrono::steady_clock::now();
+      std::size_t last = std::min(first + lanesPerBlock, members.size());
+      std::vector<EnsembleMember> block(
+          members.begin() + static_cast<std::ptrdiff_t>(first),
+          members.begin() + static_cast<std::ptrdiff_t>(last));
+
+      LaneEnsemble lanes(settings, block);
+      for (int i = 0; i < settings.steps; ++i) lanes.Step(settings.step);
+
+      float seconds = std::chrono::duration<float>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+      for (std::size_t w = 0; w < block.size(); ++w) {
+        summaries[first + w] = lanes.Summarize(w);
+        summaries[first + w].seconds = seconds;
+      }
+    }
+  };
+
+  std::size_t blocks = (members.size() + lanesPerBlock - 1) / lanesPerBlock;
+  if (pool != nullptr) {
+    pool->ParallelFor(blocks, 1, run);
+  } else {
+    run(0, blocks);
+  }
+  return summaries;
+}
@@ -0,0 +1,68 @@
+#ifndef LANE_ENSEMBLE_HPP
+#define LANE_ENSEMBLE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "ensemble.hpp"
+
+// many small worlds of the same boid count stepped together: every state
+// array is laid out as [boid][world], so the innermost loop of each kernel
+// runs over a block of laneWidth worlds and maps onto SIMD lanes, each lane
+// with its own weights and radii. The worlds have no obstacles and no arrow
+// following, and every boid meets every other boid of its world (no
+// quadtree), which suits the small flocks of a parameter sweep.
+class LaneEnsemble {
+ public:
+  LaneEnsemble(const EnsembleSettings &settings,
+               const std::vector<EnsembleMember> &members);
+
+  std::size_t GetWorldCount() const;
+  std::size_t GetBoidCount() const;
+  Vec2 GetPosition(std::size_t world, std::size_t boid) const;
+  Vec2 GetVelocity(std::size_t world, std::size_t boid) const;
+
+  // same rules and integration as Simulation::Step
+  void Step(float dt);
+  EnsembleSummary Summarize(std::size_t world) const;
+
+ private:
+  std::size_t Index(std::size_t boid, std::size_t world) const;
+  void EvaluateRules(std::size_t boid, std::size_t firstLane);
+  void Integrate(float dt);
+
+  static constexpr std::size_t laneWidth = 8;  // one AVX register of floats
+  static constexpr float tiny = 1e-30f;        // keeps unused quotients finite
+
+  float maxX;
+  float maxY;
+  std::size_t worlds;
+  std::size_t boids;
+  // worlds rounded up to whole lane blocks; the padding lanes have zero
+  // weights and speed, so they never move
+  std::size_t stride;
+
+  //------per world parameters (one lane each)-------
+  std::vector<float> separationWeight;
+  std::vector<float> alignmentWeight;
+  std::vector<float> cohesionWeight;
+  std::vector<float> separation2;
+  std::vector<float> cohesion2;
+  std::vector<float> alignment2;
+  std::vector<float> maxSpeed;
+  std::vector<float> margin;  // wrap margin, the boid radius
+
+  //------boid state, world index innermost-------
+  std::vector<float> posX, posY;
+  std::vector<float> velX, velY;
+  std::vector<float> steerX, steerY;
+};
+
+// the ensemble in blocks of lanesPerBlock worlds, one block per pool task;
+// every summary of a block reports the wall time of the whole block
+std::vector<EnsembleSummary> RunLaneEnsemble(
+    const EnsembleSettings &settings,
+    const std::vector<EnsembleMember> &members, ThreadPool *pool,
+    std::size_t lanesPerBlock = 16);
+
+#endif
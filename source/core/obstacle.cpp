@@ -1,57 +1,46 @@
 #include "obstacle.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
 #include <iostream>
 
-bool Obstacle::completeEvasion =
-    false;  // standard value for complete evasion mode
-
-float Obstacle::radius{40.f};
-int Obstacle::sides{4};
-
-Obstacle::Obstacle(sf::Vector2f position, float size)
-    : Boid(position, sf::Vector2f(0.f, 0.f)) {
+Obstacle::Obstacle(Vec2 position, float size)
+    : Boid(position, Vec2(0.f, 0.f)) {
   //------size defiintion and positivity check-----
   assert(size > 0.f && "Obstacle size must be positive");
-  shape.setSize({size, size});
-  shape.setFillColor(sf::Color::Blue);
 
-  //------origin at center positioning and check----
-  shape.setOrigin(size / 2.f, size / 2.f);
-  assert(shape.getOrigin().x == size / 2.f &&
-         shape.getOrigin().y == size / 2.f);
-  shape.setPosition(position);
+  //------square centered on the given position----
+  square = Rect(position.x - size / 2.f, position.y - size / 2.f, size, size);
+  assert(square.width == size && square.height == size);
 }
-const sf::RectangleShape &Obstacle::GetShape() const { return shape; }
-sf::FloatRect Obstacle::GetBounds() const { return shape.getGlobalBounds(); }
-void Obstacle::Update_Position() {
+Rect Obstacle::GetBounds() const { return square; }
+void Obstacle::Update_Position(float dt) {
   // do not update
+  (void)dt;
 }
-void Obstacle::SpeedChange(sf::Vector2f changedSpeed) {
+void Obstacle::SpeedChange(Vec2 changedSpeed) {
   // forced 0 speed
   (void)changedSpeed;
   this->Velocity = {0.f, 0.f};
 }
-bool Obstacle::GetEvasionState() { return completeEvasion; }
 
 //--------Collision functions---------
-void Obstacle::AlterEvasionState() { completeEvasion = !completeEvasion; }
-bool Obstacle::CollisionResponse(Boid &boid) {
+bool Obstacle::CollisionResponse(Boid &boid, bool completeEvasion) {
   if (completeEvasion) {
     return false;
   };  // no collision, just evasion
 
-  sf::FloatRect bounds = this->GetBounds();
-  sf::Vector2f pos = boid.GetPosition();
+  Rect bounds = this->GetBounds();
+  Vec2 pos = boid.GetPosition();
   assert(bounds.width > 0 && bounds.height > 0);
 
   float closestX = std::clamp(pos.x, bounds.left, bounds.left + bounds.width);
   float closestY = std::clamp(pos.y, bounds.top, bounds.top + bounds.height);
-  sf::Vector2f closestPoint(closestX, closestY);
+  Vec2 closestPoint(closestX, closestY);
 
-  sf::Vector2f diff = pos - closestPoint;
+  Vec2 diff = pos - closestPoint;
   float distance = Norm(diff);
   assert(!std::isnan(distance));
 
@@ -77,15 +66,15 @@ bool Obstacle::CollisionResponse(Boid &boid) {
 }
 
 // this function will be called only at completeEvasion == true
-sf::Vector2f Obstacle::RepelBoid(const Boid &boid, float obstacleSize) const {
-  sf::Vector2f pos = boid.GetPosition();
-  sf::FloatRect bounds = GetBounds();
+Vec2 Obstacle::RepelBoid(const Boid &boid, float obstacleSize) const {
+  Vec2 pos = boid.GetPosition();
+  Rect bounds = GetBounds();
 
   float closestX = std::clamp(pos.x, bounds.left, bounds.left + bounds.width);
   float closestY = std::clamp(pos.y, bounds.top, bounds.top + bounds.height);
-  sf::Vector2f closestPoint(closestX, closestY);
+  Vec2 closestPoint(closestX, closestY);
 
-  sf::Vector2f diff = pos - closestPoint;
+  Vec2 diff = pos - closestPoint;
   float d2 = diff.x * diff.x + diff.y * diff.y;
 
   float safety = boid.GetRadius() + obstacleSize;
@@ -98,5 +87,3 @@ sf::Vector2f Obstacle::RepelBoid(const Boid &boid, float obstacleSize) const {
   }
   return {0.f, 0.f};
 }
-
-void Obstacle::setCompleteEvasion(bool value) { completeEvasion = value; }
\ No newline at end of file
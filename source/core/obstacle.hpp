@@ -0,0 +1,30 @@
+#ifndef OBSTACLE_HPP
+#define OBSTACLE_HPP
+
+#include <array>
+
+#include "boid.hpp"
+
+class Obstacle : public Boid {
+ public:
+  Obstacle(Vec2 position, float size);
+  ~Obstacle() override = default;
+
+  //------Overridden functions-------
+  void Update_Position(float dt) override;
+  void SpeedChange(Vec2 changedSpeed) override;
+
+  //------Getters-------
+  Rect GetBounds() const;
+
+  //------Collisions functions-------
+  // in complete evasion mode the boids are steered around the obstacle and
+  // never collide with it
+  bool CollisionResponse(Boid &boid, bool completeEvasion = false);
+  Vec2 RepelBoid(const Boid &boid, float obstacleSize) const;
+
+ private:
+  Rect square;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "quadtree.hpp"
+#include <algorithm>
+#include <cassert> 
+
+Quadtree::Quadtree(float x, float y, float width, float height, int cap)
+    : boundary(x, y, width, height), capacity(cap) {
+  assert(cap > 0 && "Quadtree capacity must be positive");
+}
+
+void Quadtree::subdivide() {
+  float x = boundary.left;
+  float y = boundary.top;
+  float w = boundary.width / 2;
+  float h = boundary.height / 2;
+
+  northeast = std::make_unique<Quadtree>(x + w, y, w, h, capacity);
+  northwest = std::make_unique<Quadtree>(x, y, w, h, capacity);
+  southeast = std::make_unique<Quadtree>(x + w, y + h, w, h, capacity);
+  southwest = std::make_unique<Quadtree>(x, y + h, w, h, capacity);
+
+  divided = true;
+}
+
+bool Quadtree::insert(Boid *boid) {
+  assert(boid != nullptr);
+
+  if (!boundary.contains(boid->GetPosition())) return false;
+
+  if (points.size() < static_cast<std::size_t>(capacity)) {
+    points.push_back(boid);
+    return true;
+  }
+
+  if (!divided) subdivide();
+
+  return (northeast->insert(boid) || northwest->insert(boid) ||
+          southeast->insert(boid) || southwest->insert(boid));
+}
+
+void Quadtree::query(const Rect &range, std::vector<Boid *> &found) const {
+  assert(range.width >= 0 && range.height >= 0);
+
+  if (!boundary.intersects(range)) return;
+
+  for (Boid *b : points) {
+    if (range.contains(b->GetPosition())) found.push_back(b);
+  }
+
+  if (divided) {
+    northeast->query(range, found);
+    northwest->query(range, found);
+    southeast->query(range, found);
+    southwest->query(range, found);
+  }
+}
+
+void Quadtree::clear() {
+  points.clear();
+
+  if (divided) {
+    northeast->clear();
+    northwest->clear();
+    southeast->clear();
+    southwest->clear();
+
+    northeast.reset();
+    northwest.reset();
+    southeast.reset();
+    southwest.reset();
+    divided = false;
+  }
+}
+
+void Quadtree::summarize() {
+  total = {};
+  for (const Boid *b : points) {
+    ++total.count;
+    total.position += b->GetPosition();
+    total.velocity += b->GetVelocity();
+  }
+  if (divided) {
+    for (Quadtree *child : {northeast.get(), northwest.get(), southeast.get(),
+                            southwest.get()}) {
+      child->summarize();
+      total.count += child->total.count;
+      total.position += child->total.position;
+      total.velocity += child->total.velocity;
+    }
+  }
+}
+
+void Quadtree::aggregate(Vec2 center, float radius, float theta,
+                         const Boid *exclude, BoidAggregate &sum) const {
+  assert(radius >= 0.f && theta >= 0.f);
+  if (total.count == 0) return;
+
+  float left = boundary.left;
+  float right = boundary.left + boundary.width;
+  float top = boundary.top;
+  float bottom = boundary.top + boundary.height;
+  float radius2 = radius * radius;
+
+  // nearest point of the node out of the circle: nothing to add
+  Vec2 nearest{std::clamp(center.x, left, right),
+               std::clamp(center.y, top, bottom)};
+  if (DistSqr(nearest, center) > radius2) return;
+
+  // farthest corner in: the whole node. A node around the excluded boid is
+  // opened instead, the boid may sit in it or in any node above it
+  Vec2 farthest{center.x - left > right - center.x ? left : right,
+                center.y - top > bottom - center.y ? top : bottom};
+  bool holdsExcluded =
+      exclude != nullptr && boundary.contains(exclude->GetPosition());
+  if (DistSqr(farthest, center) <= radius2 && !holdsExcluded) {
+    sum.count += total.count;
+    sum.position += total.position;
+    sum.velocity += total.velocity;
+    return;
+  }
+
+  // a small node cut by the circle: all or nothing
+  if (boundary.width < theta * radius && !holdsExcluded) {
+    Vec2 centroid = total.position / static_cast<float>(total.count);
+    if (DistSqr(centroid, center) <= radius2) {
+      sum.count += total.count;
+      sum.position += total.position;
+      sum.velocity += total.velocity;
+    }
+    return;
+  }
+
+  for (const Boid *b : points) {
+    if (b != exclude && DistSqr(b->GetPosition(), center) <= radius2) {
+      ++sum.count;
+      sum.position += b->GetPosition();
+      sum.velocity += b->GetVelocity();
+    }
+  }
+  if (divided) {
+    northeast->aggregate(center, radius, theta, exclude, sum);
+    northwest->aggregate(center, radius, theta, exclude, sum);
+    southeast->aggregate(center, radius, theta, exclude, sum);
+    southwest->aggregate(center, radius, theta, exclude, sum);
+  }
+}
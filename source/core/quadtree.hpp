@@ -0,0 +1,55 @@
+#ifndef QUADTREE_HPP
+#define QUADTREE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "boid.hpp"
+
+// number of a set of boids with the sums of their positions and velocities
+struct BoidAggregate {
+  std::size_t count = 0;
+  Vec2 position;
+  Vec2 velocity;
+};
+
+class Quadtree {
+ public:
+  //-----Quadtree general variables----
+  Rect boundary;
+  int capacity;
+  std::vector<Boid *> points;
+  bool divided = false;
+  BoidAggregate total;  // of the whole subtree, set by summarize()
+
+  //-----Four Section Pointers-----
+
+  std::unique_ptr<Quadtree> northeast = nullptr;
+  std::unique_ptr<Quadtree> northwest = nullptr;
+  std::unique_ptr<Quadtree> southeast = nullptr;
+  std::unique_ptr<Quadtree> southwest = nullptr;
+
+  //--------------------------------
+
+  Quadtree(float x, float y, float width, float height, int cap);
+
+  //-----Section functions-------
+
+  void subdivide();
+  bool insert(Boid *boid);
+  void query(const Rect &range, std::vector<Boid *> &found) const;
+  void clear();
+
+  //-----Aggregates-------
+
+  void summarize();
+  // adds the boids within radius of center to sum, except exclude. Nodes
+  // entirely inside the circle are added whole; nodes it cuts that are
+  // smaller than theta * radius are added whole or not at all, as their
+  // centroid is in or out (theta = 0 is exact). Needs summarize() first.
+  void aggregate(Vec2 center, float radius, float theta, const Boid *exclude,
+                 BoidAggregate &sum) const;
+};
+
+#endif
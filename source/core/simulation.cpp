@@ -0,0 +1,1234 @@
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "counter_rng.hpp"
+
+namespace {
+
+// sums of one rule over the candidates it reached, with the squares of
+// their offsets from the boid's own value for the error estimate
+struct RuleSample {
+  Vec2 sum;
+  std::uint32_t hits = 0;
+  Vec2 offsets;
+  float squares = 0.f;
+
+  void Add(Vec2 value, Vec2 own) {
+    sum += value;
+    ++hits;
+    offsets += value - own;
+    squares += NormSqr(value - own);
+  }
+  // standard error of the mean of the values, drawn with replacement
+  float StandardError() const {
+    if (hits < 2) return 0.f;
+    auto h = static_cast<float>(hits);
+    float variance = std::max(squares / h - NormSqr(offsets / h), 0.f);
+    return std::sqrt(variance / h);
+  }
+};
+
+// uniform in [0, n)
+std::size_t Draw(CounterRng &rng, std::size_t n) {
+  return static_cast<std::size_t>(
+      (rng.NextU32() * static_cast<std::uint64_t>(n)) >> 32);
+}
+
+}  // namespace
+
+//------fixed timestep-------
+
+FixedTimestep::FixedTimestep(float step, int maxSteps)
+    : _step(step), _maxSteps(maxSteps) {
+  assert(step > 0.f && maxSteps > 0);
+}
+
+int FixedTimestep::Advance(float frameTime) {
+  assert(frameTime >= 0.f);
+  accumulator += frameTime;
+
+  int steps = 0;
+  while (accumulator >= _step && steps < _maxSteps) {
+    accumulator -= _step;
+    ++steps;
+  }
+  // too far behind: drop the backlog instead of trying to catch up forever
+  if (accumulator >= _step) accumulator = std::fmod(accumulator, _step);
+  return steps;
+}
+
+float FixedTimestep::GetStep() const { return _step; }
+float FixedTimestep::GetAlpha() const { return accumulator / _step; }
+
+//------simulation-------
+
+Simulation::Simulation(float width, float height, float margin,
+                       const BehaviorWeights &weights,
+                       const BoidParams &params)
+    : maxX(width),
+      maxY(height),
+      wrapMargin(margin),
+      _weights(weights),
+      _params(params),
+      tree(0.f, 0.f, width, height, 4),
+      obstacleTree(0.f, 0.f, width, height, 4) {
+  assert(width > 0.f && height > 0.f);
+}
+
+std::vector<Boid> &Simulation::GetBoids() {
+  indexDirty = true;
+  farField.clear();
+  farFieldStep.clear();
+  verletValid = false;
+  return boids;
+}
+const std::vector<Boid> &Simulation::GetBoids() const { return boids; }
+std::vector<Obstacle> &Simulation::GetObstacles() {
+  obstacleIndexDirty = true;
+  return obstacles;
+}
+const std::vector<Obstacle> &Simulation::GetObstacles() const {
+  return obstacles;
+}
+const Quadtree &Simulation::GetTree() {
+  if (indexDirty) RebuildIndex();
+  return tree;
+}
+Rect Simulation::GetWorldBounds() const { return {0.f, 0.f, maxX, maxY}; }
+const BehaviorWeights &Simulation::GetWeights() const { return _weights; }
+const BoidParams &Simulation::GetParams() const { return _params; }
+void Simulation::AddBoid(Vec2 position, Vec2 velocity) {
+  boids.emplace_back(position, velocity, &_params);
+  indexDirty = true;
+  verletValid = false;
+}
+void Simulation::AddObstacle(Vec2 position, float size) {
+  obstacles.emplace_back(position, size);
+  obstacleIndexDirty = true;
+}
+
+//------spatial queries-------
+
+void Simulation::QueryBoids(const Rect &range, std::vector<Boid *> &found) {
+  if (indexDirty) RebuildIndex();
+  tree.query(range, found);
+}
+
+void Simulation::QueryObstacles(const Rect &range,
+                                std::vector<const Obstacle *> &found) {
+  if (obstacleIndexDirty) RebuildObstacleIndex();
+
+  // centers up to half a side away can still overlap the range
+  Rect reach(range.left - obstacleReach, range.top - obstacleReach,
+             range.width + 2 * obstacleReach, range.height + 2 * obstacleReach);
+  std::vector<Boid *> candidates;
+  obstacleTree.query(reach, candidates);
+  for (const Boid *candidate : candidates) {
+    // only obstacles are ever inserted in this tree
+    const auto *obs = static_cast<const Obstacle *>(candidate);
+    if (obs->GetBounds().intersects(range)) found.push_back(obs);
+  }
+}
+
+void Simulation::RebuildIndex() {
+  tree.clear();
+
+  // insertion of boids into quadtree
+  for (Boid &boid : boids) {
+    tree.insert(&boid);
+  }
+  indexDirty = false;
+}
+
+void Simulation::RebuildObstacleIndex() {
+  obstacleTree.clear();
+  obstacleReach = 0.f;
+  unindexedObstacles.clear();
+  for (Obstacle &obs : obstacles) {
+    if (!obstacleTree.insert(&obs)) unindexedObstacles.push_back(&obs);
+    obstacleReach = std::max(obstacleReach, obs.GetBounds().width / 2.f);
+  }
+  obstacleIndexDirty = false;
+}
+
+void Simulation::SetMouseFollow(bool enabled, Vec2 mousePos) {
+  mouseFollowMode = enabled;
+  mousePosition = mousePos;
+}
+bool Simulation::GetMouseFollow() const { return mouseFollowMode; }
+void Simulation::SetCompleteEvasion(bool enabled) { completeEvasion = enabled; }
+bool Simulation::GetCompleteEvasion() const { return completeEvasion; }
+void Simulation::SetDeterministic(bool enabled) { deterministic = enabled; }
+bool Simulation::GetDeterministic() const { return deterministic; }
+void Simulation::SetRuleKernel(RuleKernel kernel) { ruleKernel = kernel; }
+RuleKernel Simulation::GetRuleKernel() const { return ruleKernel; }
+void Simulation::SetAggregateTheta(float theta) {
+  assert(theta >= 0.f);
+  aggregateTheta = theta;
+}
+float Simulation::GetAggregateTheta() const { return aggregateTheta; }
+void Simulation::SetSummedAreaCell(float cell) {
+  assert(cell >= 0.f);
+  areaCell = cell;
+}
+float Simulation::GetSummedAreaCell() const { return areaCell; }
+void Simulation::SetNeighborSampling(std::size_t samples,
+                                     std::size_t threshold,
+                                     std::uint64_t seed) {
+  assert(samples > 0 && samples <= threshold);
+  samplingSamples = samples;
+  samplingThreshold = threshold;
+  samplingSeed = seed;
+}
+const SamplingReport &Simulation::GetSamplingReport() const {
+  return samplingReport;
+}
+void Simulation::SetMultiRatePeriod(std::uint32_t period) {
+  assert(period > 0);
+  multiRatePeriod = period;
+}
+std::uint32_t Simulation::GetMultiRatePeriod() const {
+  return multiRatePeriod;
+}
+void Simulation::SetVerletSkin(float skin) {
+  assert(skin > 0.f);
+  verletSkin = skin;
+  verletValid = false;
+}
+float Simulation::GetVerletSkin() const { return verletSkin; }
+std::size_t Simulation::GetVerletBuilds() const { return verletBuilds; }
+void Simulation::SetTopologicalNeighbors(std::size_t k) {
+  assert(k > 0);
+  topologicalNeighbors = k;
+}
+std::size_t Simulation::GetTopologicalNeighbors() const {
+  return topologicalNeighbors;
+}
+
+void Simulation::SetThreadPool(ThreadPool *pool) { _pool = pool; }
+const CostModel &Simulation::GetCostModel() const { return costModel; }
+
+void Simulation::ForEachChunk(
+    std::size_t count, std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)> &body) {
+  if (_pool != nullptr) {
+    _pool->ParallelFor(count, grain, body);
+  } else {
+    body(0, count);
+  }
+}
+
+//------step phases-------
+
+void Simulation::Step(float dt) { Step(dt, nullptr); }
+
+void Simulation::Step(float dt, const std::function<void()> &consume) {
+  if (indexDirty) RebuildIndex();
+  if (obstacleIndexDirty) RebuildObstacleIndex();
+
+  obstaclePtrs.clear();
+  for (Obstacle &obs : obstacles) {
+    obstaclePtrs.push_back(&obs);
+  }
+  steeringFunction = SelectSteering(_weights, completeEvasion, mouseFollowMode);
+  BehaviorWeights others = _weights;
+  others.separation = others.alignment = others.cohesion = 0.f;
+  extraSteeringFunction =
+      SelectSteering(others, completeEvasion, mouseFollowMode);
+  steering.resize(boids.size());
+  killLists.resize(std::max<std::size_t>(
+      (boids.size() + collisionGrain - 1) / collisionGrain, 1));
+  for (std::vector<std::size_t> &kills : killLists) kills.clear();
+  PartitionRules();
+
+  // rules -> integration -> collisions -> compaction, then the index for
+  // the next step is built while the caller consumes this step's state
+  graph.Clear();
+  TaskGraph::TaskId rules = graph.Add([this] {
+    switch (deterministic ? RuleKernel::PerBoid : ruleKernel) {
+      case RuleKernel::PerBoid:
+        ForEachChunk(ruleSamples.size(), 1,
+                     [this](std::size_t begin, std::size_t end) {
+                       for (std::size_t c = begin; c < end; ++c) {
+                         EvaluateRules(c);
+                       }
+                     });
+        costModel.Fit(ruleSamples);
+        break;
+      case RuleKernel::Pairwise:
+        EvaluatePairwise();
+        break;
+      case RuleKernel::Tiled:
+        EvaluateTiled();
+        break;
+      case RuleKernel::Aggregated:
+        EvaluateAggregated();
+        break;
+      case RuleKernel::SummedArea:
+        EvaluateSummedArea();
+        break;
+      case RuleKernel::Sampled:
+        EvaluateSampled();
+        break;
+      case RuleKernel::MultiRate:
+        // boids without a cached far field are due at once
+        farField.resize(boids.size());
+        farFieldStep.resize(boids.size(), stepCount - multiRatePeriod);
+        ForEachChunk(boids.size(), minRuleChunk,
+                     [this](std::size_t begin, std::size_t end) {
+                       EvaluateMultiRate(begin, end);
+                     });
+        break;
+      case RuleKernel::Verlet:
+        if (!CollectStragglers()) BuildVerlet();
+        ForEachChunk(boids.size(), minRuleChunk,
+                     [this](std::size_t begin, std::size_t end) {
+                       EvaluateVerlet(begin, end);
+                     });
+        break;
+      case RuleKernel::Topological:
+        EvaluateTopological();
+        break;
+    }
+  });
+  TaskGraph::TaskId integrate = graph.Add([this, dt] {
+    ForEachChunk(boids.size(), integrateGrain,
+                 [this, dt](std::size_t begin, std::size_t end) {
+                   IntegrateBoids(begin, end, dt);
+                 });
+  });
+  TaskGraph::TaskId collide = graph.Add([this, dt] {
+    ForEachChunk(boids.size(), collisionGrain,
+                 [this, dt](std::size_t begin, std::size_t end) {
+                   DetectCollisions(begin, end, dt);
+                 });
+  });
+  TaskGraph::TaskId compact = graph.Add([this] { CompactDead(); });
+  TaskGraph::TaskId index = graph.Add([this] { RebuildIndex(); });
+
+  graph.Precede(rules, integrate);
+  graph.Precede(integrate, collide);
+  graph.Precede(collide, compact);
+  graph.Precede(compact, index);
+  if (consume) {
+    TaskGraph::TaskId fill = graph.Add(consume);
+    graph.Precede(compact, fill);
+  }
+
+  graph.Run(_pool);
+  ++stepCount;
+}
+
+void Simulation::PartitionRules() {
+  // boids spawned since the last step have no history yet and count as
+  // having no neighbors
+  neighborCounts.resize(boids.size(), 0);
+
+  std::size_t parts = 1;
+  if (_pool != nullptr) {
+    parts = std::min(_pool->GetThreadCount() * chunksPerThread,
+                     std::max<std::size_t>(boids.size() / minRuleChunk, 1));
+  }
+  costModel.Partition(neighborCounts, parts, ruleBounds);
+  ruleSamples.assign(ruleBounds.size() - 1, {});
+}
+
+void Simulation::EvaluateRules(std::size_t chunk) {
+  auto start = std::chrono::steady_clock::now();
+  std::size_t begin = ruleBounds[chunk];
+  std::size_t end = ruleBounds[chunk + 1];
+  std::size_t visited = 0;
+
+  // every boid reads the state of the previous step only, its own steering
+  // is kept apart until all of them are evaluated
+  std::vector<Boid *> neighbors;
+  for (std::size_t i = begin; i < end; ++i) {
+    const Boid &boid = boids[i];
+    float maxRadius =
+        std::max({_params.separation, _params.cohesion, _params.alignment});
+    Vec2 pos = boid.GetPosition();
+    Rect queryRange(pos.x - maxRadius, pos.y - maxRadius, 2 * maxRadius,
+                    2 * maxRadius);
+
+    neighbors.clear();
+    tree.query(queryRange,
+               neighbors);  // restriction to closer boids through quadtree
+    if (deterministic) SortCanonical(neighbors);
+    neighborCounts[i] = static_cast<std::uint32_t>(neighbors.size());
+    visited += neighbors.size();
+
+    steering[i] = steeringFunction(
+        boid, {neighbors, obstaclePtrs, _weights, mousePosition});
+  }
+
+  ChunkSample &sample = ruleSamples[chunk];
+  sample.boids = end - begin;
+  sample.neighbors = visited;
+  sample.seconds = std::chrono::duration<float>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+}
+
+//------other rule kernels-------
+
+void Simulation::BuildCells(std::size_t columns, std::size_t rows) {
+  float cellWidth = maxX / static_cast<float>(columns);
+  float cellHeight = maxY / static_cast<float>(rows);
+  std::size_t cells = columns * rows;
+  Rect world = GetWorldBounds();
+  gridColumns = columns;
+
+  // counting sort of the boids by cell, in boid order within a cell
+  cellOf.resize(boids.size());
+  cellStart.assign(cells + 1, 0);
+  outsideBoids.clear();
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    Vec2 pos = boids[i].GetPosition();
+    if (!world.contains(pos)) {
+      cellOf[i] = cells;
+      outsideBoids.push_back(i);
+      continue;
+    }
+    std::size_t column =
+        std::min(static_cast<std::size_t>(pos.x / cellWidth), columns - 1);
+    std::size_t row =
+        std::min(static_cast<std::size_t>(pos.y / cellHeight), rows - 1);
+    cellOf[i] = row * columns + column;
+    ++cellStart[cellOf[i] + 1];
+  }
+  for (std::size_t c = 0; c < cells; ++c) cellStart[c + 1] += cellStart[c];
+
+  cellBoids.resize(cellStart[cells]);
+  cellPositions.resize(cellStart[cells]);
+  cellVelocities.resize(cellStart[cells]);
+  std::vector<std::size_t> next(cellStart.begin(), cellStart.end() - 1);
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    if (cellOf[i] == cells) continue;
+    std::size_t slot = next[cellOf[i]]++;
+    cellBoids[slot] = i;
+    cellPositions[slot] = boids[i].GetPosition();
+    cellVelocities[slot] = boids[i].GetVelocity();
+  }
+}
+
+void Simulation::AddFarField(const Boid &boid, const FlockSums &sums,
+                              Vec2 &force) const {
+  // as AlnSpeed and CohSpeed on the finished sums
+  Vec2 pos = boid.GetPosition();
+  Vec2 vel = boid.GetVelocity();
+  if (sums.alignment > 0) {
+    Vec2 valg = sums.velocity / static_cast<float>(sums.alignment);
+    float n2 = NormSqr(valg);
+    if (n2 != 0) force += _weights.alignment * (Normalized(valg, n2) - vel);
+  }
+  if (sums.cohesion > 0) {
+    Vec2 vcoh = sums.position / static_cast<float>(sums.cohesion) - pos;
+    float n2 = NormSqr(vcoh);
+    if (n2 != 0) force += _weights.cohesion * (Normalized(vcoh, n2) - vel);
+  }
+}
+
+Vec2 Simulation::FinishSums(const Boid &boid, const FlockSums &sums,
+                            const Vec2 *cached) const {
+  Vec2 force{0.f, 0.f};
+  if (!boid.GetHitStatus()) {
+    if (sums.separation != Vec2{0.f, 0.f}) {
+      force += _weights.separation * Normalized(sums.separation);
+    }
+    if (cached != nullptr) {
+      force += *cached;
+    } else {
+      AddFarField(boid, sums, force);
+    }
+  }
+  const std::vector<Boid *> none;
+  return force + extraSteeringFunction(
+                     boid, {none, obstaclePtrs, _weights, mousePosition});
+}
+
+void Simulation::EvaluateOutside(std::size_t begin, std::size_t end) {
+  // outside the world nobody sees the boid, it still sees the others
+  float maxRadius =
+      std::max({_params.separation, _params.cohesion, _params.alignment});
+  std::vector<Boid *> neighbors;
+  for (std::size_t k = begin; k < end; ++k) {
+    std::size_t i = outsideBoids[k];
+    Vec2 pos = boids[i].GetPosition();
+    neighbors.clear();
+    tree.query(Rect(pos.x - maxRadius, pos.y - maxRadius, 2 * maxRadius,
+                    2 * maxRadius),
+               neighbors);
+    neighborCounts[i] = static_cast<std::uint32_t>(neighbors.size());
+    steering[i] = steeringFunction(
+        boids[i], {neighbors, obstaclePtrs, _weights, mousePosition});
+  }
+}
+
+void Simulation::EvaluatePairwise() {
+  float maxRadius =
+      std::max({_params.separation, _params.cohesion, _params.alignment});
+  std::size_t strips =
+      std::max<std::size_t>(static_cast<std::size_t>(maxX / maxRadius), 1);
+  BuildCells(strips, 1);
+  pairSums.assign(boids.size(), {});
+
+  // even strips, then odd ones: the strips of one pass write to disjoint
+  // boids, and every boid receives its sums in the same order whatever the
+  // thread count
+  for (std::size_t parity = 0; parity < 2; ++parity) {
+    ForEachChunk((strips + 1 - parity) / 2, 1,
+                 [this, parity](std::size_t begin, std::size_t end) {
+                   for (std::size_t k = begin; k < end; ++k) {
+                     EvaluatePairs(2 * k + parity);
+                   }
+                 });
+  }
+  ForEachChunk(boids.size(), integrateGrain,
+               [this](std::size_t begin, std::size_t end) {
+                 FinishPairs(begin, end);
+               });
+  ForEachChunk(outsideBoids.size(), minRuleChunk,
+               [this](std::size_t begin, std::size_t end) {
+                 EvaluateOutside(begin, end);
+               });
+}
+
+void Simulation::EvaluatePairs(std::size_t strip) {
+  float maxRadius =
+      std::max({_params.separation, _params.cohesion, _params.alignment});
+  float sep2 = _params.separation * _params.separation;
+  float coh2 = _params.cohesion * _params.cohesion;
+  float alg2 = _params.alignment * _params.alignment;
+
+  std::vector<Boid *> found;
+  for (std::size_t s = cellStart[strip]; s < cellStart[strip + 1]; ++s) {
+    std::size_t i = cellBoids[s];
+    Vec2 pos = cellPositions[s];
+    Vec2 vel = cellVelocities[s];
+
+    // the right half of the usual range only: each pair is found from its
+    // left end, or from both ends when they share x
+    found.clear();
+    tree.query(Rect(pos.x, pos.y - maxRadius, maxRadius, 2 * maxRadius),
+               found);
+    neighborCounts[i] = static_cast<std::uint32_t>(found.size());
+
+    for (Boid *other : found) {
+      auto j = static_cast<std::size_t>(other - boids.data());
+      Vec2 otherPos = other->GetPosition();
+      if (j == i || (otherPos.x == pos.x && j < i)) continue;
+      // a strip rounded away still lies a whole reach off, out of every
+      // radius; skipping it keeps the passes apart
+      if (cellOf[j] > strip + 1) continue;
+
+      Vec2 away = pos - otherPos;
+      float d2 = NormSqr(away);
+      FlockSums &mine = pairSums[i];
+      FlockSums &theirs = pairSums[j];
+      if (d2 <= sep2 && d2 != 0) {
+        Vec2 unit = Normalized(away, d2);
+        mine.separation += unit;
+        theirs.separation -= unit;
+      }
+      if (d2 <= coh2) {
+        mine.position += otherPos;
+        theirs.position += pos;
+        ++mine.cohesion;
+        ++theirs.cohesion;
+      }
+      if (d2 <= alg2) {
+        mine.velocity += other->GetVelocity();
+        theirs.velocity += vel;
+        ++mine.alignment;
+        ++theirs.alignment;
+      }
+    }
+  }
+}
+
+void Simulation::FinishPairs(std::size_t begin, std::size_t end) {
+  std::size_t strips = cellStart.size() - 1;
+  for (std::size_t i = begin; i < end; ++i) {
+    if (cellOf[i] < strips) steering[i] = FinishSums(boids[i], pairSums[i]);
+  }
+}
+
+void Simulation::EvaluateTiled() {
+  float maxRadius =
+      std::max({_params.separation, _params.cohesion, _params.alignment});
+  std::size_t columns =
+      std::max<std::size_t>(static_cast<std::size_t>(maxX / maxRadius), 1);
+  std::size_t rows =
+      std::max<std::size_t>(static_cast<std::size_t>(maxY / maxRadius), 1);
+  BuildCells(columns, rows);
+
+  // a boid only writes its own steering, so the cells run in parallel
+  ForEachChunk(columns * rows, cellGrain,
+               [this](std::size_t begin, std::size_t end) {
+                 EvaluateCells(begin, end);
+               });
+  ForEachChunk(outsideBoids.size(), minRuleChunk,
+               [this](std::size_t begin, std::size_t end) {
+                 EvaluateOutside(begin, end);
+               });
+}
+
+void Simulation::EvaluateCells(std::size_t begin, std::size_t end) {
+  float sep2 = _params.separation * _params.separation;
+  float coh2 = _params.cohesion * _params.cohesion;
+  float alg2 = _params.alignment * _params.alignment;
+  std::size_t rows = (cellStart.size() - 1) / gridColumns;
+
+  std::vector<FlockSums> sums;
+  for (std::size_t cell = begin; cell < end; ++cell) {
+    std::size_t first = cellStart[cell];
+    std::size_t last = cellStart[cell + 1];
+    if (first == last) continue;
+    sums.assign(last - first, {});
+
+    // the cells around are three runs of the sorted copies, one per row;
+    // each run is read in tiles, and a tile meets every boid of the cell
+    // before the next one is loaded
+    std::size_t column = cell % gridColumns;
+    std::size_t row = cell / gridColumns;
+    std::size_t left = column > 0 ? column - 1 : 0;
+    std::size_t right = std::min(column + 1, gridColumns - 1);
+    std::size_t candidates = 0;
+    for (std::size_t r = row > 0 ? row - 1 : 0; r <= row + 1 && r < rows;
+         ++r) {
+      std::size_t runEnd = cellStart[r * gridColumns + right + 1];
+      for (std::size_t tile = cellStart[r * gridColumns + left];
+           tile < runEnd; tile += tileBoids) {
+        std::size_t tileEnd = std::min(tile + tileBoids, runEnd);
+        candidates += tileEnd - tile;
+        for (std::size_t s = first; s < last; ++s) {
+          Vec2 pos = cellPositions[s];
+          FlockSums &mine = sums[s - first];
+          for (std::size_t t = tile; t < tileEnd; ++t) {
+            if (t == s) continue;
+            Vec2 away = pos - cellPositions[t];
+            float d2 = NormSqr(away);
+            if (d2 <= sep2 && d2 != 0) {
+              mine.separation += Normalized(away, d2);
+            }
+            if (d2 <= coh2) {
+              mine.position += cellPositions[t];
+              ++mine.cohesion;
+            }
+            if (d2 <= alg2) {
+              mine.velocity += cellVelocities[t];
+              ++mine.alignment;
+            }
+          }
+        }
+      }
+    }
+
+    for (std::size_t s = first; s < last; ++s) {
+      std::size_t i = cellBoids[s];
+      neighborCounts[i] = static_cast<std::uint32_t>(candidates);
+      steering[i] = FinishSums(boids[i], sums[s - first]);
+    }
+  }
+}
+
+void Simulation::SumSeparation(std::size_t i, std::vector<Boid *> &close,
+                               FlockSums &sums) {
+  // exact, separation needs every direction on its own
+  const Boid &boid = boids[i];
+  Vec2 pos = boid.GetPosition();
+  float sep2 = _params.separation * _params.separation;
+  close.clear();
+  tree.query(Rect(pos.x - _params.separation, pos.y - _params.separation,
+                  2 * _params.separation, 2 * _params.separation),
+             close);
+  neighborCounts[i] = static_cast<std::uint32_t>(close.size());
+  for (const Boid *other : close) {
+    Vec2 away = pos - other->GetPosition();
+    float d2 = NormSqr(away);
+    if (other != &boid && d2 <= sep2 && d2 != 0) {
+      sums.separation += Normalized(away, d2);
+    }
+  }
+}
+
+void Simulation::EvaluateAggregated() {
+  // the boids have not moved since the index was built
+  tree.summarize();
+  ForEachChunk(boids.size(), minRuleChunk,
+               [this](std::size_t begin, std::size_t end) {
+                 EvaluateAggregated(begin, end);
+               });
+}
+
+void Simulation::EvaluateAggregated(std::size_t begin, std::size_t end) {
+  std::vector<Boid *> close;
+  for (std::size_t i = begin; i < end; ++i) {
+    const Boid &boid = boids[i];
+    Vec2 pos = boid.GetPosition();
+    FlockSums sums;
+    SumSeparation(i, close, sums);
+
+    // cohesion and alignment only need counts and sums
+    BoidAggregate cohesion;
+    BoidAggregate alignment;
+    tree.aggregate(pos, _params.cohesion, aggregateTheta, &boid, cohesion);
+    tree.aggregate(pos, _params.alignment, aggregateTheta, &boid, alignment);
+    sums.position = cohesion.position;
+    sums.cohesion = static_cast<std::uint32_t>(cohesion.count);
+    sums.velocity = alignment.velocity;
+    sums.alignment = static_cast<std::uint32_t>(alignment.count);
+    steering[i] = FinishSums(boid, sums);
+  }
+}
+
+void Simulation::EvaluateSummedArea() {
+  float cell = areaCell > 0.f ? areaCell : _params.cohesion / 4.f;
+  areaGrid.Build(boids, maxX, maxY, cell);
+  cohesionBoxes = areaGrid.DiscBoxes(_params.cohesion);
+  alignmentBoxes = areaGrid.DiscBoxes(_params.alignment);
+  ForEachChunk(boids.size(), minRuleChunk,
+               [this](std::size_t begin, std::size_t end) {
+                 EvaluateSummedArea(begin, end);
+               });
+}
+
+void Simulation::EvaluateSummedArea(std::size_t begin, std::size_t end) {
+  Rect world = GetWorldBounds();
+  std::vector<Boid *> close;
+  for (std::size_t i = begin; i < end; ++i) {
+    const Boid &boid = boids[i];
+    Vec2 pos = boid.GetPosition();
+    Vec2 vel = boid.GetVelocity();
+    FlockSums sums;
+    SumSeparation(i, close, sums);
+
+    AreaSums cohesion = areaGrid.Sum(pos, cohesionBoxes);
+    AreaSums alignment = areaGrid.Sum(pos, alignmentBoxes);
+    // a boid in the world sits in the middle cell of both discs
+    if (world.contains(pos)) {
+      for (AreaSums *area : {&cohesion, &alignment}) {
+        --area->count;
+        area->x -= pos.x;
+        area->y -= pos.y;
+        area->vx -= vel.x;
+        area->vy -= vel.y;
+      }
+    }
+    sums.position = {static_cast<float>(cohesion.x),
+                     static_cast<float>(cohesion.y)};
+    sums.cohesion = cohesion.count;
+    sums.velocity = {static_cast<float>(alignment.vx),
+                     static_cast<float>(alignment.vy)};
+    sums.alignment = alignment.count;
+    steering[i] = FinishSums(boid, sums);
+  }
+}
+
+void Simulation::EvaluateSampled() {
+  // alignment draws from the grid cells around the boid, which give the
+  // number of candidates without visiting them
+  std::size_t columns = std::max<std::size_t>(
+      static_cast<std::size_t>(maxX / _params.alignment), 1);
+  std::size_t rows = std::max<std::size_t>(
+      static_cast<std::size_t>(maxY / _params.alignment), 1);
+  BuildCells(columns, rows);
+
+  samplingParts.assign((boids.size() + samplingGrain - 1) / samplingGrain,
+                       {});
+  ForEachChunk(boids.size(), samplingGrain,
+               [this](std::size_t begin, std::size_t end) {
+                 EvaluateSampled(begin, end);
+               });
+
+  samplingReport = {};
+  for (const SamplingReport &part : samplingParts) {
+    samplingReport.sampled += part.sampled;
+    samplingReport.cohesion += part.cohesion;
+    samplingReport.alignment += part.alignment;
+  }
+  if (samplingReport.sampled > 0) {
+    auto sampled = static_cast<float>(samplingReport.sampled);
+    samplingReport.cohesion /= sampled;
+    samplingReport.alignment /= sampled;
+  }
+}
+
+void Simulation::EvaluateSampled(std::size_t begin, std::size_t end) {
+  SamplingReport &report = samplingParts[begin / samplingGrain];
+  float coh2 = _params.cohesion * _params.cohesion;
+  float alg2 = _params.alignment * _params.alignment;
+  auto rows = static_cast<std::ptrdiff_t>((cellStart.size() - 1) / gridColumns);
+  auto columns = static_cast<std::ptrdiff_t>(gridColumns);
+  float cellWidth = maxX / static_cast<float>(columns);
+  float cellHeight = maxY / static_cast<float>(rows);
+
+  std::vector<Boid *> close;
+  std::vector<Boid *> candidates;
+  for (std::size_t i = begin; i < end; ++i) {
+    const Boid &boid = boids[i];
+    Vec2 pos = boid.GetPosition();
+    Vec2 vel = boid.GetVelocity();
+    FlockSums sums;
+    SumSeparation(i, close, sums);
+    CounterRng rng(samplingSeed, i, stepCount);
+
+    // cohesion: its small range is listed from the index
+    RuleSample cohesion;
+    candidates.clear();
+    tree.query(Rect(pos.x - _params.cohesion, pos.y - _params.cohesion,
+                    2 * _params.cohesion, 2 * _params.cohesion),
+               candidates);
+    std::erase(candidates, &boid);
+    bool sampleCohesion = candidates.size() > samplingThreshold;
+    std::size_t draws = sampleCohesion ? samplingSamples : candidates.size();
+    for (std::size_t k = 0; k < draws; ++k) {
+      const Boid *other =
+          candidates[sampleCohesion ? Draw(rng, candidates.size()) : k];
+      Vec2 otherPos = other->GetPosition();
+      if (DistSqr(otherPos, pos) <= coh2) cohesion.Add(otherPos, pos);
+    }
+
+    // alignment: the 3 x 3 cells around are three runs of the sorted
+    // copies, counted without being read
+    RuleSample alignment;
+    auto column =
+        static_cast<std::ptrdiff_t>(std::floor(pos.x / cellWidth));
+    auto row = static_cast<std::ptrdiff_t>(std::floor(pos.y / cellHeight));
+    std::size_t runBegin[3];
+    std::size_t runEnd[3];
+    std::size_t total = 0;
+    for (std::ptrdiff_t r = 0; r < 3; ++r) {
+      std::ptrdiff_t y = row - 1 + r;
+      std::ptrdiff_t left = std::max<std::ptrdiff_t>(column - 1, 0);
+      std::ptrdiff_t right = std::min(column + 1, columns - 1);
+      runBegin[r] = runEnd[r] = 0;
+      if (y < 0 || y >= rows || left > right) continue;
+      runBegin[r] = cellStart[static_cast<std::size_t>(y * columns + left)];
+      runEnd[r] = cellStart[static_cast<std::size_t>(y * columns + right + 1)];
+      total += runEnd[r] - runBegin[r];
+    }
+    bool sampleAlignment = total > samplingThreshold + 1;
+    auto visit = [&](std::size_t t) {
+      if (cellBoids[t] == i) return;
+      if (DistSqr(cellPositions[t], pos) <= alg2) {
+        alignment.Add(cellVelocities[t], vel);
+      }
+    };
+    if (sampleAlignment) {
+      for (std::size_t k = 0; k < samplingSamples; ++k) {
+        std::size_t t = Draw(rng, total);
+        std::size_t r = 0;
+        for (; t >= runEnd[r] - runBegin[r]; ++r) t -= runEnd[r] - runBegin[r];
+        visit(runBegin[r] + t);
+      }
+    } else {
+      for (std::size_t r = 0; r < 3; ++r) {
+        for (std::size_t t = runBegin[r]; t < runEnd[r]; ++t) visit(t);
+      }
+    }
+
+    sums.position = cohesion.sum;
+    sums.cohesion = cohesion.hits;
+    sums.velocity = alignment.sum;
+    sums.alignment = alignment.hits;
+    if (sampleCohesion || sampleAlignment) {
+      ++report.sampled;
+      if (sampleCohesion) report.cohesion += cohesion.StandardError();
+      if (sampleAlignment) report.alignment += alignment.StandardError();
+    }
+    steering[i] = FinishSums(boid, sums);
+  }
+}
+
+void Simulation::EvaluateMultiRate(std::size_t begin, std::size_t end) {
+  float maxRadius =
+      std::max({_params.separation, _params.cohesion, _params.alignment});
+  float sep2 = _params.separation * _params.separation;
+  float coh2 = _params.cohesion * _params.cohesion;
+  float alg2 = _params.alignment * _params.alignment;
+
+  std::vector<Boid *> neighbors;
+  for (std::size_t i = begin; i < end; ++i) {
+    const Boid &boid = boids[i];
+    Vec2 pos = boid.GetPosition();
+    FlockSums sums;
+
+    // a boid is due on its turn, staggered by index, or once its cache is
+    // a whole period old (indexes shift as boids are destroyed)
+    bool due = (i + stepCount) % multiRatePeriod == 0 ||
+               stepCount - farFieldStep[i] >= multiRatePeriod;
+    if (!due) {
+      SumSeparation(i, neighbors, sums);
+      steering[i] = FinishSums(boid, sums, &farField[i]);
+      continue;
+    }
+
+    neighbors.clear();
+    tree.query(Rect(pos.x - maxRadius, pos.y - maxRadius, 2 * maxRadius,
+                    2 * maxRadius),
+               neighbors);
+    neighborCounts[i] = static_cast<std::uint32_t>(neighbors.size());
+    for (const Boid *other : neighbors) {
+      if (other == &boid) continue;
+      Vec2 otherPos = other->GetPosition();
+      Vec2 away = pos - otherPos;
+      float d2 = NormSqr(away);
+      if (d2 <= sep2 && d2 != 0) sums.separation += Normalized(away, d2);
+      if (d2 <= coh2) {
+        sums.position += otherPos;
+        ++sums.cohesion;
+      }
+      if (d2 <= alg2) {
+        sums.velocity += other->GetVelocity();
+        ++sums.alignment;
+      }
+    }
+    farField[i] = {0.f, 0.f};
+    AddFarField(boid, sums, farField[i]);
+    farFieldStep[i] = stepCount;
+    steering[i] = FinishSums(boid, sums, &farField[i]);
+  }
+}
+
+bool Simulation::CollectStragglers() {
+  stragglers.clear();
+  if (!verletValid || verletOrigins.size() != boids.size()) return false;
+
+  // pairs within a radius now were within radius + skin at the build as
+  // long as neither boid moved more than half the skin; the border decides
+  // who is in the index at all. Every other boid checks every straggler,
+  // so near the cap a step costs up to N * N / 128 extra distances.
+  float limit = verletSkin / 2.f;
+  Rect world = GetWorldBounds();
+  std::size_t maxStragglers =
+      std::max(minStragglers, boids.size() / stragglerShare);
+  straggling.assign(boids.size(), 0);
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    Vec2 pos = boids[i].GetPosition();
+    Vec2 origin = verletOrigins[i];
+    if (DistSqr(pos, origin) > limit * limit ||
+        world.contains(pos) != world.contains(origin)) {
+      if (stragglers.size() == maxStragglers) return false;
+      stragglers.push_back(static_cast<std::uint32_t>(i));
+      straggling[i] = 1;
+    }
+  }
+  return true;
+}
+
+void Simulation::BuildVerlet() {
+  float reach =
+      std::max({_params.separation, _params.cohesion, _params.alignment}) +
+      verletSkin;
+  std::size_t count = boids.size();
+  verletStart.assign(count + 1, 0);
+  verletOrigins.resize(count);
+  verletParts.resize((count + verletGrain - 1) / verletGrain);
+
+  // the chunks list their boids apart, counts go to verletStart[i + 1]
+  ForEachChunk(count, verletGrain,
+               [this, reach](std::size_t begin, std::size_t end) {
+                 std::vector<std::uint32_t> &part =
+                     verletParts[begin / verletGrain];
+                 part.clear();
+                 float reach2 = reach * reach;
+                 std::vector<Boid *> found;
+                 for (std::size_t i = begin; i < end; ++i) {
+                   Vec2 pos = boids[i].GetPosition();
+                   verletOrigins[i] = pos;
+                   found.clear();
+                   tree.query(Rect(pos.x - reach, pos.y - reach, 2 * reach,
+                                   2 * reach),
+                              found);
+                   std::size_t listed = 0;
+                   for (const Boid *other : found) {
+                     if (other == &boids[i] ||
+                         DistSqr(other->GetPosition(), pos) > reach2) {
+                       continue;
+                     }
+                     part.push_back(
+                         static_cast<std::uint32_t>(other - boids.data()));
+                     ++listed;
+                   }
+                   verletStart[i + 1] = listed;
+                 }
+               });
+  for (std::size_t i = 0; i < count; ++i) verletStart[i + 1] += verletStart[i];
+
+  verletNeighbors.resize(verletStart[count]);
+  ForEachChunk(count, verletGrain,
+               [this](std::size_t begin, std::size_t) {
+                 const std::vector<std::uint32_t> &part =
+                     verletParts[begin / verletGrain];
+                 std::copy(part.begin(), part.end(),
+                           verletNeighbors.begin() +
+                               static_cast<std::ptrdiff_t>(verletStart[begin]));
+               });
+  verletValid = true;
+  ++verletBuilds;
+}
+
+void Simulation::EvaluateVerlet(std::size_t begin, std::size_t end) {
+  float maxRadius =
+      std::max({_params.separation, _params.cohesion, _params.alignment});
+  float sep2 = _params.separation * _params.separation;
+  float coh2 = _params.cohesion * _params.cohesion;
+  float alg2 = _params.alignment * _params.alignment;
+  Rect world = GetWorldBounds();
+  std::vector<Boid *> found;
+
+  for (std::size_t i = begin; i < end; ++i) {
+    const Boid &boid = boids[i];
+    Vec2 pos = boid.GetPosition();
+    FlockSums sums;
+    std::uint32_t candidates = 0;
+    auto add = [&](const Boid &other) {
+      Vec2 otherPos = other.GetPosition();
+      Vec2 away = pos - otherPos;
+      float d2 = NormSqr(away);
+      if (d2 <= sep2 && d2 != 0) sums.separation += Normalized(away, d2);
+      if (d2 <= coh2) {
+        sums.position += otherPos;
+        ++sums.cohesion;
+      }
+      if (d2 <= alg2) {
+        sums.velocity += other.GetVelocity();
+        ++sums.alignment;
+      }
+      ++candidates;
+    };
+
+    if (!stragglers.empty() && straggling[i]) {
+      // its list is stale, the index is not
+      found.clear();
+      tree.query(Rect(pos.x - maxRadius, pos.y - maxRadius, 2 * maxRadius,
+                      2 * maxRadius),
+                 found);
+      for (const Boid *other : found) {
+        if (other != &boid) add(*other);
+      }
+    } else {
+      for (std::size_t k = verletStart[i]; k < verletStart[i + 1]; ++k) {
+        std::uint32_t j = verletNeighbors[k];
+        if (stragglers.empty() || !straggling[j]) add(boids[j]);
+      }
+      for (std::uint32_t j : stragglers) {
+        if (world.contains(boids[j].GetPosition())) add(boids[j]);
+      }
+    }
+    neighborCounts[i] = candidates;
+    steering[i] = FinishSums(boid, sums);
+  }
+}
+
+void Simulation::EvaluateTopological() {
+  // cells of about k / 2 boids on average, so the k nearest are mostly
+  // within the first ring around the own cell
+  auto k = static_cast<float>(topologicalNeighbors);
+  auto count = static_cast<float>(std::max<std::size_t>(boids.size(), 1));
+  float side = std::sqrt(maxX * maxY * k / (2.f * count));
+  auto cellsAlong = [side](float length) {
+    return std::clamp<std::size_t>(static_cast<std::size_t>(length / side), 1,
+                                   1024);
+  };
+  BuildCells(cellsAlong(maxX), cellsAlong(maxY));
+  ForEachChunk(boids.size(), minRuleChunk,
+               [this](std::size_t begin, std::size_t end) {
+                 EvaluateTopological(begin, end);
+               });
+}
+
+void Simulation::EvaluateTopological(std::size_t begin, std::size_t end) {
+  auto columns = static_cast<std::ptrdiff_t>(gridColumns);
+  auto rows = static_cast<std::ptrdiff_t>(cellStart.size() - 1) / columns;
+  float cellWidth = maxX / static_cast<float>(columns);
+  float cellHeight = maxY / static_cast<float>(rows);
+  float sep2 = _params.separation * _params.separation;
+  std::size_t k = topologicalNeighbors;
+
+  // bounded max-heap of the k nearest so far, by distance then slot so
+  // that ties do not depend on the scan order
+  using Candidate = std::pair<float, std::size_t>;
+  std::vector<Candidate> nearest;
+  nearest.reserve(k + 1);
+
+  auto cellAt = [&](float x, float y) {
+    auto column = static_cast<std::ptrdiff_t>(std::floor(x / cellWidth));
+    auto row = static_cast<std::ptrdiff_t>(std::floor(y / cellHeight));
+    return std::pair{std::clamp<std::ptrdiff_t>(column, 0, columns - 1),
+                     std::clamp<std::ptrdiff_t>(row, 0, rows - 1)};
+  };
+  auto cellIndex = [columns](std::ptrdiff_t column, std::ptrdiff_t row) {
+    return static_cast<std::size_t>(row * columns + column);
+  };
+
+  for (std::size_t i = begin; i < end; ++i) {
+    const Boid &boid = boids[i];
+    Vec2 pos = boid.GetPosition();
+    FlockSums sums;
+    std::uint32_t candidates = 0;
+    nearest.clear();
+
+    auto scanCell = [&](std::size_t cell) {
+      for (std::size_t s = cellStart[cell]; s < cellStart[cell + 1]; ++s) {
+        std::size_t j = cellBoids[s];
+        if (j == i) continue;
+        ++candidates;
+        Candidate candidate{DistSqr(cellPositions[s], pos), s};
+        if (nearest.size() < k) {
+          nearest.push_back(candidate);
+          std::push_heap(nearest.begin(), nearest.end());
+        } else if (candidate < nearest.front()) {
+          std::pop_heap(nearest.begin(), nearest.end());
+          nearest.back() = candidate;
+          std::push_heap(nearest.begin(), nearest.end());
+        }
+      }
+    };
+
+    // expanding square rings around the own cell (the closest one for a
+    // boid in the margin), until no cell outside them can hold a boid
+    // closer than the k-th nearest
+    auto [cx, cy] = cellAt(pos.x, pos.y);
+    for (std::ptrdiff_t r = 0;; ++r) {
+      std::ptrdiff_t left = cx - r, right = cx + r;
+      std::ptrdiff_t top = cy - r, bottom = cy + r;
+      for (std::ptrdiff_t row = std::max(top, std::ptrdiff_t{0});
+           row <= std::min(bottom, rows - 1); ++row) {
+        if (row == top || row == bottom) {
+          for (std::ptrdiff_t column = std::max(left, std::ptrdiff_t{0});
+               column <= std::min(right, columns - 1); ++column) {
+            scanCell(cellIndex(column, row));
+          }
+        } else {
+          if (left >= 0) scanCell(cellIndex(left, row));
+          if (right < columns) scanCell(cellIndex(right, row));
+        }
+      }
+
+      // distance to the closest cell not scanned yet, on the sides where
+      // the grid goes on
+      float gap = std::numeric_limits<float>::infinity();
+      if (left > 0) {
+        gap = std::min(gap, pos.x - static_cast<float>(left) * cellWidth);
+      }
+      if (right < columns - 1) {
+        gap = std::min(gap, static_cast<float>(right + 1) * cellWidth - pos.x);
+      }
+      if (top > 0) {
+        gap = std::min(gap, pos.y - static_cast<float>(top) * cellHeight);
+      }
+      if (bottom < rows - 1) {
+        gap = std::min(gap,
+                       static_cast<float>(bottom + 1) * cellHeight - pos.y);
+      }
+      if (gap == std::numeric_limits<float>::infinity()) break;
+      if (nearest.size() == k && gap > 0.f &&
+          nearest.front().first <= gap * gap) {
+        break;
+      }
+    }
+
+    for (const Candidate &candidate : nearest) {
+      sums.position += cellPositions[candidate.second];
+      sums.velocity += cellVelocities[candidate.second];
+    }
+    sums.cohesion = sums.alignment = static_cast<std::uint32_t>(nearest.size());
+
+    // separation over the cells its radius reaches
+    auto [firstColumn, firstRow] =
+        cellAt(pos.x - _params.separation, pos.y - _params.separation);
+    auto [lastColumn, lastRow] =
+        cellAt(pos.x + _params.separation, pos.y + _params.separation);
+    for (std::ptrdiff_t row = firstRow; row <= lastRow; ++row) {
+      std::size_t first = cellStart[cellIndex(firstColumn, row)];
+      std::size_t last = cellStart[cellIndex(lastColumn, row) + 1];
+      for (std::size_t s = first; s < last; ++s) {
+        Vec2 away = pos - cellPositions[s];
+        float d2 = NormSqr(away);
+        if (d2 <= sep2 && d2 != 0) sums.separation += Normalized(away, d2);
+      }
+    }
+
+    neighborCounts[i] = candidates;
+    steering[i] = FinishSums(boid, sums);
+  }
+}
+
+//------integration and collisions-------
+
+void Simulation::IntegrateBoids(std::size_t begin, std::size_t end, float dt) {
+  for (std::size_t i = begin; i < end; ++i) {
+    Integrate(boids[i], steering[i], maxX, maxY, wrapMargin, dt);
+  }
+}
+
+void Simulation::DetectCollisions(std::size_t begin, std::size_t end,
+                                  float dt) {
+  // a boid only touches itself, so the chunks run in parallel; the deaths
+  // go to the chunk's own kill list
+  std::vector<std::size_t> &kills = killLists[begin / collisionGrain];
+  std::vector<Boid *> candidates;
+  for (std::size_t i = begin; i < end; ++i) {
+    Vec2 pos = boids[i].GetPosition();
+    float reach = boids[i].GetRadius() + obstacleReach;
+    candidates.assign(unindexedObstacles.begin(), unindexedObstacles.end());
+    obstacleTree.query(Rect(pos.x - reach, pos.y - reach, 2 * reach,
+                            2 * reach),
+                       candidates);
+    // the first obstacle hit in list order wins, as with a plain scan
+    std::sort(candidates.begin(), candidates.end(), std::less<Boid *>());
+
+    bool collided = false;
+    for (Boid *candidate : candidates) {
+      auto *obstacle = static_cast<Obstacle *>(candidate);
+      if (obstacle->CollisionResponse(boids[i], completeEvasion)) {
+        collided = true;
+        break;
+      }
+    }
+
+    if (collided && boids[i].UpdateHit(dt)) {
+      kills.push_back(i);  // should be destroyed
+    }
+  }
+}
+
+void Simulation::CompactDead() {
+  // order preserving removal of the destroyed boids; the kill lists are
+  // sorted, and so is their concatenation
+  std::size_t kept = 0;
+  std::size_t next = 0;
+  auto keepUntil = [&](std::size_t until) {
+    for (; next < until; ++next, ++kept) {
+      if (kept == next) continue;
+      boids[kept] = std::move(boids[next]);
+      neighborCounts[kept] = neighborCounts[next];
+      if (next < farField.size()) {
+        farField[kept] = farField[next];
+        farFieldStep[kept] = farFieldStep[next];
+      }
+    }
+  };
+  for (const std::vector<std::size_t> &kills : killLists) {
+    for (std::size_t killed : kills) {
+      keepUntil(killed);
+      ++next;  // skip the destroyed one
+    }
+  }
+  keepUntil(boids.size());
+  if (kept < boids.size()) verletValid = false;
+  boids.erase(boids.begin() + static_cast<std::ptrdiff_t>(kept), boids.end());
+  neighborCounts.resize(kept);
+  if (farField.size() > kept) {
+    farField.resize(kept);
+    farFieldStep.resize(kept);
+  }
+}
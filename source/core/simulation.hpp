@@ -0,0 +1,301 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "cost_model.hpp"
+#include "evolution.hpp"
+#include "quadtree.hpp"
+#include "summed_area.hpp"
+#include "task_graph.hpp"
+#include "thread_pool.hpp"
+
+// accumulator of real elapsed time, turned into a whole number of fixed
+// simulation steps; the leftover fraction is used to interpolate the drawing
+class FixedTimestep {
+ public:
+  FixedTimestep(float step, int maxSteps);
+
+  int Advance(float frameTime);
+  float GetStep() const;
+  float GetAlpha() const;
+
+ private:
+  float _step;
+  int _maxSteps;  // spiral of death cap on the steps of a single frame
+  float accumulator = 0.f;
+};
+
+// how the flocking rules find the neighbours of the boids
+enum class RuleKernel {
+  PerBoid,     // one index query per boid
+  Pairwise,    // each neighbour pair measured once, for both boids
+  Tiled,       // one candidate tile per grid cell, shared by its boids
+  Aggregated,  // cohesion and alignment from index node aggregates
+  SummedArea,  // cohesion and alignment from a summed-area grid
+  Sampled,     // cohesion and alignment from a sample of the crowded ones
+  MultiRate,   // cohesion and alignment cached for a few steps
+  Verlet,      // neighbour lists with a skin, kept for several steps
+  Topological,  // cohesion and alignment from the k nearest neighbours
+};
+
+// estimated error of the sampled kernel in the last step: the standard
+// errors of the sampled mean neighbour position and velocity, averaged
+// over the boids that were sampled
+struct SamplingReport {
+  std::size_t sampled = 0;  // boids
+  float cohesion = 0.f;
+  float alignment = 0.f;
+};
+
+// running sums of the flocking rules of one boid, for the kernels that
+// do not go through the rule pack
+struct FlockSums {
+  Vec2 separation;  // unit vectors away from the boids too close
+  Vec2 position;
+  Vec2 velocity;
+  std::uint32_t cohesion = 0;   // boids summed into position
+  std::uint32_t alignment = 0;  // boids summed into velocity
+};
+
+// boids, obstacles, spatial index and parameters of one running flock;
+// nothing is shared between instances, so any number of them can run side
+// by side (the boids point at the parameters, hence no copies or moves)
+class Simulation {
+ public:
+  Simulation(float width, float height, float margin,
+             const BehaviorWeights &weights,
+             const BoidParams &params = BoidParams{});
+  Simulation(const Simulation &) = delete;
+  Simulation &operator=(const Simulation &) = delete;
+
+  //------state access-------
+  // mutable access may reallocate the vectors, so it invalidates the indexes
+  std::vector<Boid> &GetBoids();
+  const std::vector<Boid> &GetBoids() const;
+  std::vector<Obstacle> &GetObstacles();
+  const std::vector<Obstacle> &GetObstacles() const;
+  const Quadtree &GetTree();
+  Rect GetWorldBounds() const;
+  const BehaviorWeights &GetWeights() const;
+  // boids added through GetBoids() should be given these parameters
+  const BoidParams &GetParams() const;
+  void AddBoid(Vec2 position, Vec2 velocity);
+  void AddObstacle(Vec2 position, float size);
+
+  //------spatial queries (e.g. view culling)-------
+  void QueryBoids(const Rect &range, std::vector<Boid *> &found);
+  void QueryObstacles(const Rect &range, std::vector<const Obstacle *> &found);
+
+  //------modes-------
+  void SetMouseFollow(bool enabled, Vec2 mousePos);
+  bool GetMouseFollow() const;
+  void SetCompleteEvasion(bool enabled);
+  bool GetCompleteEvasion() const;
+  // neighbours summed in canonical order: trajectories no longer depend on
+  // the order the boids were added in, at the cost of a sort per boid
+  void SetDeterministic(bool enabled);
+  bool GetDeterministic() const;
+  // kernels other than PerBoid take their sums in another order, and some
+  // approximate them as set below; none of them depends on the thread
+  // count. The deterministic mode takes precedence.
+  void SetRuleKernel(RuleKernel kernel);
+  RuleKernel GetRuleKernel() const;
+  // opening parameter of the aggregated kernel, see Quadtree::aggregate;
+  // 0 keeps the neighbour sets exact
+  void SetAggregateTheta(float theta);
+  float GetAggregateTheta() const;
+  // cell side of the summed-area kernel, 0 for a quarter of the cohesion
+  // radius; its discs are made of whole cells, so the radii are only kept
+  // to about a cell
+  void SetSummedAreaCell(float cell);
+  float GetSummedAreaCell() const;
+  // a boid of the sampled kernel with more than threshold candidates for
+  // cohesion or alignment takes that rule from samples of them, drawn with
+  // replacement from a stream keyed by the seed, its index and the step;
+  // separation stays exact
+  void SetNeighborSampling(std::size_t samples, std::size_t threshold,
+                           std::uint64_t seed = 0);
+  const SamplingReport &GetSamplingReport() const;
+  // the multi-rate kernel recomputes the cohesion and alignment of a boid
+  // every period steps, a 1 / period share of the boids in each step, and
+  // reuses them in between; separation, evasion and arrow following still
+  // run every step. Period 1 recomputes everything.
+  void SetMultiRatePeriod(std::uint32_t period);
+  std::uint32_t GetMultiRatePeriod() const;
+  // the Verlet kernel lists the neighbours of every boid within the
+  // largest radius plus the skin, and only lists them again once too many
+  // boids have moved more than half the skin or crossed the world border;
+  // the few that did are checked against everyone meanwhile
+  void SetVerletSkin(float skin);
+  float GetVerletSkin() const;
+  std::size_t GetVerletBuilds() const;  // since the start
+  // the topological kernel takes cohesion and alignment from the k nearest
+  // boids instead of those within the radii, whatever their distance, so
+  // the work per boid does not grow with the density; separation keeps
+  // its radius
+  void SetTopologicalNeighbors(std::size_t k);
+  std::size_t GetTopologicalNeighbors() const;
+
+  //------evolution-------
+  // with a pool the phases of a step run in parallel chunks
+  void SetThreadPool(ThreadPool *pool);
+  const CostModel &GetCostModel() const;
+  void Step(float dt);
+  // consume runs once the step is complete, concurrently with the index
+  // build for the next step: it may read the boids and obstacles but must
+  // not use the boid index (QueryBoids)
+  void Step(float dt, const std::function<void()> &consume);
+
+ private:
+  void ForEachChunk(std::size_t count, std::size_t grain,
+                    const std::function<void(std::size_t, std::size_t)> &body);
+  void PartitionRules();
+  void EvaluateRules(std::size_t chunk);
+  void BuildCells(std::size_t columns, std::size_t rows);
+  // alignment and cohesion of the sums, weighted
+  void AddFarField(const Boid &boid, const FlockSums &sums,
+                   Vec2 &force) const;
+  // the total steering from the sums, or from the separation sum and a
+  // cached far field
+  Vec2 FinishSums(const Boid &boid, const FlockSums &sums,
+                  const Vec2 *cached = nullptr) const;
+  void EvaluateOutside(std::size_t begin, std::size_t end);
+  void EvaluatePairwise();
+  void EvaluatePairs(std::size_t strip);
+  void FinishPairs(std::size_t begin, std::size_t end);
+  void EvaluateTiled();
+  void EvaluateCells(std::size_t begin, std::size_t end);
+  void SumSeparation(std::size_t i, std::vector<Boid *> &close,
+                     FlockSums &sums);
+  void EvaluateAggregated();
+  void EvaluateAggregated(std::size_t begin, std::size_t end);
+  void EvaluateSummedArea();
+  void EvaluateSummedArea(std::size_t begin, std::size_t end);
+  void EvaluateSampled();
+  void EvaluateSampled(std::size_t begin, std::size_t end);
+  void EvaluateMultiRate(std::size_t begin, std::size_t end);
+  bool CollectStragglers();
+  void BuildVerlet();
+  void EvaluateVerlet(std::size_t begin, std::size_t end);
+  void EvaluateTopological();
+  void EvaluateTopological(std::size_t begin, std::size_t end);
+  void IntegrateBoids(std::size_t begin, std::size_t end, float dt);
+  void DetectCollisions(std::size_t begin, std::size_t end, float dt);
+  void CompactDead();
+  void RebuildIndex();
+  void RebuildObstacleIndex();
+
+  float maxX;
+  float maxY;
+  float wrapMargin;
+  BehaviorWeights _weights;
+  BoidParams _params;
+  bool completeEvasion = false;
+  bool deterministic = false;
+  RuleKernel ruleKernel = RuleKernel::PerBoid;
+  float aggregateTheta = 0.f;
+  float areaCell = 0.f;
+  std::size_t samplingSamples = 64;
+  std::size_t samplingThreshold = 128;
+  std::uint64_t samplingSeed = 0;
+  std::uint32_t multiRatePeriod = 4;
+  float verletSkin = 10.f;
+  std::size_t topologicalNeighbors = 7;
+  std::uint32_t stepCount = 0;
+  bool mouseFollowMode = false;
+  Vec2 mousePosition;
+
+  std::vector<Boid> boids;
+  std::vector<Obstacle> obstacles;
+  Quadtree tree;
+  Quadtree obstacleTree;  // obstacles are indexed by their center
+  float obstacleReach = 0.f;  // largest half side of an obstacle
+  // obstacles centered outside the world, which the index cannot hold
+  std::vector<Obstacle *> unindexedObstacles;
+  bool indexDirty = true;
+  bool obstacleIndexDirty = true;
+
+  //------per step scratch data-------
+  ThreadPool *_pool = nullptr;
+  TaskGraph graph;
+  std::vector<Obstacle *> obstaclePtrs;
+  SteeringFunction steeringFunction = nullptr;  // for this step's modes
+  std::vector<Vec2> steering;
+  // destroyed boids, one list per collision chunk in boid order; removed
+  // together once the phase is over
+  std::vector<std::vector<std::size_t>> killLists;
+
+  //------pairwise and tiled kernels-------
+  // the rules besides flocking, added on top of the flocking sums
+  SteeringFunction extraSteeringFunction = nullptr;
+  // boids in the world bucketed by a grid of cells at least one query reach
+  // wide, with copies of their state in that order; cellOf is the cell
+  // count for the boids outside the world, which the index does not hold
+  std::size_t gridColumns = 1;
+  std::vector<std::size_t> cellOf;
+  std::vector<std::size_t> cellStart;
+  std::vector<std::size_t> cellBoids;
+  std::vector<Vec2> cellPositions;
+  std::vector<Vec2> cellVelocities;
+  std::vector<std::size_t> outsideBoids;
+  // the pairwise kernel uses a single row of cells, vertical strips: the
+  // pairs found from strip s end in s or s + 1, so strips two apart never
+  // write to the same boid
+  std::vector<FlockSums> pairSums;
+  // candidates of the tiled kernel met by all the boids of a cell before
+  // the next ones are read: 256 of them stay within 4 kB
+  static constexpr std::size_t tileBoids = 256;
+  static constexpr std::size_t cellGrain = 16;
+
+  //------summed-area kernel-------
+  SummedAreaGrid areaGrid;
+  std::vector<CellBox> cohesionBoxes;
+  std::vector<CellBox> alignmentBoxes;
+
+  //------sampled kernel-------
+  // sums of the error estimates, one per chunk of samplingGrain boids
+  std::vector<SamplingReport> samplingParts;
+  SamplingReport samplingReport;
+  static constexpr std::size_t samplingGrain = 256;
+
+  //------multi-rate kernel-------
+  // weighted cohesion and alignment of every boid and the step they were
+  // computed in, kept in boid order; cleared by mutable access to the boids
+  std::vector<Vec2> farField;
+  std::vector<std::uint32_t> farFieldStep;
+
+  //------Verlet kernel-------
+  // compressed sparse rows: the neighbours of boid i are verletNeighbors
+  // [verletStart[i], verletStart[i + 1]), as boid indexes; any change to
+  // the boid indexes invalidates them
+  bool verletValid = false;
+  std::size_t verletBuilds = 0;
+  std::vector<std::size_t> verletStart;
+  std::vector<std::uint32_t> verletNeighbors;
+  std::vector<Vec2> verletOrigins;  // positions at the build
+  std::vector<std::uint32_t> stragglers;  // boids the lists are wrong for
+  std::vector<std::uint8_t> straggling;   // per boid
+  // the lists of each build chunk before they are joined
+  std::vector<std::vector<std::uint32_t>> verletParts;
+  static constexpr std::size_t verletGrain = 1024;
+  // the lists are rebuilt beyond 32 stragglers or one boid in 128
+  static constexpr std::size_t minStragglers = 32;
+  static constexpr std::size_t stragglerShare = 128;
+
+  //------load balancing-------
+  // neighbors each boid had in the last step, kept in boid order
+  std::vector<std::uint32_t> neighborCounts;
+  CostModel costModel;
+  std::vector<std::size_t> ruleBounds;
+  std::vector<ChunkSample> ruleSamples;
+  static constexpr std::size_t chunksPerThread = 4;
+  static constexpr std::size_t minRuleChunk = 64;  // boids
+  static constexpr std::size_t integrateGrain = 4096;
+  static constexpr std::size_t collisionGrain = 1024;
+};
+
+#endif
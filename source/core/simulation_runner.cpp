@@ -0,0 +1,154 @@
+#include "simulation_runner.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+using Clock = std::chrono::steady_clock;
+
+float FrameSnapshot::AlphaAt(Clock::time_point now) const {
+  if (step <= 0.f) return 1.f;
+  float elapsed = std::chrono::duration<float>(now - publishedAt).count();
+  return std::clamp(elapsed / step, 0.f, 1.f);
+}
+
+Command Command::SpawnBoid(Vec2 position, Vec2 velocity) {
+  Command command;
+  command.type = CommandType::SpawnBoid;
+  command.position = position;
+  command.velocity = velocity;
+  return command;
+}
+Command Command::PlaceObstacle(Vec2 position, float size) {
+  Command command;
+  command.type = CommandType::PlaceObstacle;
+  command.position = position;
+  command.size = size;
+  return command;
+}
+Command Command::SetMouseFollow(bool enabled, Vec2 mousePos) {
+  Command command;
+  command.type = CommandType::SetMouseFollow;
+  command.enabled = enabled;
+  command.position = mousePos;
+  return command;
+}
+Command Command::SetEvasion(bool enabled) {
+  Command command;
+  command.type = CommandType::SetEvasion;
+  command.enabled = enabled;
+  return command;
+}
+Command Command::SetViewArea(const Rect &area) {
+  Command command;
+  command.type = CommandType::SetViewArea;
+  command.area = area;
+  return command;
+}
+
+SimulationRunner::SimulationRunner(Simulation &simulation, float step,
+                                   int maxStepsPerFrame)
+    : _simulation(simulation),
+      timestep(step, maxStepsPerFrame),
+      viewArea(simulation.GetWorldBounds()) {}
+
+SimulationRunner::~SimulationRunner() { Stop(); }
+
+void SimulationRunner::Start() {
+  assert(!running && "SimulationRunner already started");
+  running = true;
+  worker = std::thread([this] { Run(); });
+}
+
+void SimulationRunner::Stop() {
+  running = false;
+  if (worker.joinable()) worker.join();
+}
+
+bool SimulationRunner::Send(const Command &command) {
+  return commands.TryPush(command);
+}
+
+const FrameSnapshot &SimulationRunner::AcquireSnapshot() {
+  return snapshots.Read();
+}
+
+void SimulationRunner::Run() {
+  Publish();  // initial state, before the first step
+  Clock::time_point last = Clock::now();
+
+  while (running.load(std::memory_order_relaxed)) {
+    Command command;
+    while (commands.TryPop(command)) Apply(command);
+
+    Clock::time_point now = Clock::now();
+    float elapsed = std::chrono::duration<float>(now - last).count();
+    last = now;
+
+    // the snapshot of the last step is filled while the simulation already
+    // builds the index for the following one
+    int steps = timestep.Advance(elapsed);
+    for (int i = 0; i < steps; ++i) {
+      ++stepCount;
+      if (i + 1 < steps) {
+        _simulation.Step(timestep.GetStep());
+      } else {
+        _simulation.Step(timestep.GetStep(), [this] { Publish(); });
+      }
+    }
+
+    // sleep until the next step is due
+    float wait = (1.f - timestep.GetAlpha()) * timestep.GetStep();
+    std::this_thread::sleep_for(std::chrono::duration<float>(wait));
+  }
+}
+
+void SimulationRunner::Apply(const Command &command) {
+  switch (command.type) {
+    case CommandType::SpawnBoid:
+      _simulation.AddBoid(command.position, command.velocity);
+      break;
+    case CommandType::PlaceObstacle:
+      _simulation.AddObstacle(command.position, command.size);
+      break;
+    case CommandType::SetMouseFollow:
+      _simulation.SetMouseFollow(command.enabled, command.position);
+      break;
+    case CommandType::SetEvasion:
+      _simulation.SetCompleteEvasion(command.enabled);
+      break;
+    case CommandType::SetViewArea:
+      viewArea = command.area;
+      break;
+  }
+}
+
+void SimulationRunner::Publish() {
+  FrameSnapshot &snapshot = snapshots.WriteBuffer();
+  const std::vector<Boid> &boids = std::as_const(_simulation).GetBoids();
+
+  // the boid index may be under construction for the next step, so the
+  // boids are culled by a plain scan; obstacles keep their own index
+  visibleObstacles.clear();
+  _simulation.QueryObstacles(viewArea, visibleObstacles);
+
+  // the vectors keep their capacity from the snapshot this buffer held before
+  snapshot.boids.clear();
+  for (const Boid &boid : boids) {
+    if (!viewArea.contains(boid.GetPosition())) continue;
+    snapshot.boids.push_back({boid.GetPosition(), boid.GetPreviousPosition(),
+                              boid.GetVelocity(), boid.GetDamage()});
+  }
+  snapshot.obstacles.clear();
+  for (const Obstacle *obs : visibleObstacles) {
+    snapshot.obstacles.push_back(obs->GetBounds());
+  }
+
+  snapshot.totalBoids = boids.size();
+  snapshot.totalObstacles = std::as_const(_simulation).GetObstacles().size();
+  snapshot.boidRadius = _simulation.GetParams().radius;
+  snapshot.step = timestep.GetStep();
+  snapshot.stepCount = stepCount;
+  snapshot.publishedAt = Clock::now();
+  snapshots.Publish();
+}
@@ -0,0 +1,100 @@
+#ifndef SIMULATION_RUNNER_HPP
+#define SIMULATION_RUNNER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "simulation.hpp"
+#include "spsc_queue.hpp"
+#include "triple_buffer.hpp"
+
+// ---- SNAPSHOTS (simulation -> render) ---
+
+struct BoidSnapshot {
+  Vec2 position;
+  Vec2 previousPosition;
+  Vec2 velocity;
+  int damage = 0;
+};
+
+// immutable copy of what the render thread needs after a step; only the
+// boids and obstacles in the requested view area are copied
+struct FrameSnapshot {
+  std::vector<BoidSnapshot> boids;
+  std::vector<Rect> obstacles;
+  std::size_t totalBoids = 0;
+  std::size_t totalObstacles = 0;
+  float boidRadius = 0.f;
+  float step = 0.f;
+  std::uint64_t stepCount = 0;
+  std::chrono::steady_clock::time_point publishedAt;
+
+  // interpolation factor between the last two steps at the given time
+  float AlphaAt(std::chrono::steady_clock::time_point now) const;
+};
+
+// ---- COMMANDS (UI -> simulation) ---
+
+enum class CommandType {
+  SpawnBoid,
+  PlaceObstacle,
+  SetMouseFollow,
+  SetEvasion,
+  SetViewArea
+};
+
+struct Command {
+  CommandType type = CommandType::SpawnBoid;
+  Vec2 position;  // spawn/obstacle position or mouse position
+  Vec2 velocity;  // spawn velocity
+  float size = 0.f;
+  bool enabled = false;
+  Rect area;  // view area to copy into the snapshots
+
+  static Command SpawnBoid(Vec2 position, Vec2 velocity);
+  static Command PlaceObstacle(Vec2 position, float size);
+  static Command SetMouseFollow(bool enabled, Vec2 mousePos);
+  static Command SetEvasion(bool enabled);
+  static Command SetViewArea(const Rect &area);
+};
+
+// ---- RUNNER ---
+
+// runs a simulation on its own thread at a fixed rate; the owning (render)
+// thread talks to it only through the command queue and the snapshots
+class SimulationRunner {
+ public:
+  SimulationRunner(Simulation &simulation, float step, int maxStepsPerFrame);
+  ~SimulationRunner();
+  SimulationRunner(const SimulationRunner &) = delete;
+  SimulationRunner &operator=(const SimulationRunner &) = delete;
+
+  void Start();
+  void Stop();
+
+  // false when the queue is full and the command was dropped
+  bool Send(const Command &command);
+  // latest published state, valid until the next call
+  const FrameSnapshot &AcquireSnapshot();
+
+ private:
+  void Run();
+  void Apply(const Command &command);
+  void Publish();
+
+  Simulation &_simulation;
+  FixedTimestep timestep;
+  std::thread worker;
+  std::atomic<bool> running{false};
+  std::uint64_t stepCount = 0;
+  Rect viewArea;
+  std::vector<const Obstacle *> visibleObstacles;
+
+  SpscQueue<Command, 1024> commands;
+  TripleBuffer<FrameSnapshot> snapshots;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// bounded lock-free ring buffer for exactly one producer and one consumer
+// thread; a full queue rejects the push instead of blocking
+template <class T, std::size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SpscQueue capacity must be a power of two");
+
+ public:
+  bool TryPush(const T &value) {
+    std::size_t tail = producerIndex.load(std::memory_order_relaxed);
+    if (tail - consumerIndex.load(std::memory_order_acquire) == Capacity) {
+      return false;  // full
+    }
+    slots[tail & (Capacity - 1)] = value;
+    producerIndex.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T &value) {
+    std::size_t head = consumerIndex.load(std::memory_order_relaxed);
+    if (head == producerIndex.load(std::memory_order_acquire)) {
+      return false;  // empty
+    }
+    value = slots[head & (Capacity - 1)];
+    consumerIndex.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  std::array<T, Capacity> slots{};
+  // separate cache lines, so the two threads do not fight over them
+  alignas(64) std::atomic<std::size_t> producerIndex{0};
+  alignas(64) std::atomic<std::size_t> consumerIndex{0};
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "steering_rules.hpp"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace {
+
+// bit i of the index enables rule i: separation, alignment, cohesion,
+// evasion, mouse following
+template <std::size_t Mask>
+constexpr SteeringFunction MaskedSteering() {
+  return &ComposeSteering<OptionalRule<(Mask & 1) != 0, SeparationRule>,
+                          OptionalRule<(Mask & 2) != 0, AlignmentRule>,
+                          OptionalRule<(Mask & 4) != 0, CohesionRule>,
+                          OptionalRule<(Mask & 8) != 0, EvasionRule>,
+                          OptionalRule<(Mask & 16) != 0, MouseFollowRule>>;
+}
+
+template <std::size_t... Masks>
+constexpr std::array<SteeringFunction, sizeof...(Masks)> MakeTable(
+    std::index_sequence<Masks...>) {
+  return {MaskedSteering<Masks>()...};
+}
+
+constexpr auto steeringTable = MakeTable(std::make_index_sequence<32>{});
+
+}  // namespace
+
+SteeringFunction SelectSteering(const BehaviorWeights &weights,
+                                bool completeEvasion, bool mouseFollowMode) {
+  std::size_t mask = 0;
+  if (weights.separation != 0.f) mask |= 1;
+  if (weights.alignment != 0.f) mask |= 2;
+  if (weights.cohesion != 0.f) mask |= 4;
+  if (completeEvasion) mask |= 8;
+  if (mouseFollowMode) mask |= 16;
+  return steeringTable[mask];
+}
@@ -0,0 +1,141 @@
+#ifndef STEERING_RULES_HPP
+#define STEERING_RULES_HPP
+
+#include <concepts>
+#include <vector>
+
+#include "flock.hpp"
+#include "obstacle.hpp"
+
+// these are default values for the weights or multiplying factors for each
+// force
+struct BehaviorWeights {
+  float alignment = 1e-4f;
+  float separation = 3e-4f;
+  float cohesion = 1e-4f;
+  float evasion = 5e-1f;
+  // last one refers to the separation force from the obstacles
+};
+
+// everything a rule may read besides the boid itself
+struct SteeringContext {
+  const std::vector<Boid *> &neighbors;
+  const std::vector<Obstacle *> &obstacles;
+  const BehaviorWeights &weights;
+  Vec2 mousePos;
+};
+
+// a rule adds its force to the total; flocking rules never reach a boid
+// that is frozen by a hit, and a rule that freezesHit keeps such a boid
+// still whatever the other rules say
+template <class Rule>
+concept SteeringRule =
+    requires(const Boid &boid, const SteeringContext &context, Vec2 &force) {
+      { Rule::flocking } -> std::convertible_to<bool>;
+      { Rule::freezesHit } -> std::convertible_to<bool>;
+      Rule::Apply(boid, context, force);
+    };
+
+//------rules-------
+
+struct SeparationRule {
+  static constexpr bool flocking = true;
+  static constexpr bool freezesHit = false;
+  static void Apply(const Boid &boid, const SteeringContext &context,
+                    Vec2 &force) {
+    force += context.weights.separation * SepSpeed(&boid, context.neighbors);
+  }
+};
+
+struct AlignmentRule {
+  static constexpr bool flocking = true;
+  static constexpr bool freezesHit = false;
+  static void Apply(const Boid &boid, const SteeringContext &context,
+                    Vec2 &force) {
+    force += context.weights.alignment * AlnSpeed(&boid, context.neighbors);
+  }
+};
+
+struct CohesionRule {
+  static constexpr bool flocking = true;
+  static constexpr bool freezesHit = false;
+  static void Apply(const Boid &boid, const SteeringContext &context,
+                    Vec2 &force) {
+    force += context.weights.cohesion * CohSpeed(&boid, context.neighbors);
+  }
+};
+
+// complete evasion: pushed away from every obstacle close by
+struct EvasionRule {
+  static constexpr bool flocking = false;
+  static constexpr bool freezesHit = false;
+  static void Apply(const Boid &boid, const SteeringContext &context,
+                    Vec2 &force) {
+    for (const Obstacle *obs : context.obstacles) {
+      force += context.weights.evasion *
+               obs->RepelBoid(boid, 20.f);  // tweak size as needed
+    }
+  }
+};
+
+// arrow following: pulled towards the mouse
+struct MouseFollowRule {
+  static constexpr bool flocking = false;
+  static constexpr bool freezesHit = true;
+  static void Apply(const Boid &boid, const SteeringContext &context,
+                    Vec2 &force) {
+    Vec2 toMouse = context.mousePos - boid.GetPosition();
+    float dist = Norm(toMouse);
+    if (dist > 0.01f) force += (toMouse / dist) * 0.1f;
+  }
+};
+
+// a rule of the pack that is compiled in or out
+template <bool Enabled, SteeringRule Rule>
+struct OptionalRule {
+  static constexpr bool flocking = Rule::flocking;
+  static constexpr bool freezesHit = Enabled && Rule::freezesHit;
+  static void Apply(const Boid &boid, const SteeringContext &context,
+                    Vec2 &force) {
+    if constexpr (Enabled) Rule::Apply(boid, context, force);
+  }
+};
+
+//------composition-------
+
+// total steering force of a fixed set of rules: flocking rules first, in
+// pack order, then the others
+template <SteeringRule... Rules>
+Vec2 ComposeSteering(const Boid &boid, const SteeringContext &context) {
+  Vec2 force{0.f, 0.f};
+  (
+      [&] {
+        if constexpr (Rules::flocking) Rules::Apply(boid, context, force);
+      }(),
+      ...);
+
+  // keep boid still until the collision has had effect
+  bool hit = boid.GetHitStatus();
+  if (hit) force = {0.f, 0.f};
+
+  (
+      [&] {
+        if constexpr (!Rules::flocking) Rules::Apply(boid, context, force);
+      }(),
+      ...);
+
+  if constexpr ((Rules::freezesHit || ...)) {
+    if (hit) return {0.f, 0.f};
+  }
+  return force;
+}
+
+using SteeringFunction = Vec2 (*)(const Boid &, const SteeringContext &);
+
+// the instantiation for the current weights and modes: rules with a zero
+// weight and modes that are off are not compiled into it. Meant to be
+// picked once per step, not once per boid.
+SteeringFunction SelectSteering(const BehaviorWeights &weights,
+                                bool completeEvasion, bool mouseFollowMode);
+
+#endif
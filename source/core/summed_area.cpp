@@ -0,0 +1,102 @@
+#include "summed_area.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+void SummedAreaGrid::Build(const std::vector<Boid> &boids, float width,
+                           float height, float cell) {
+  assert(width > 0.f && height > 0.f && cell > 0.f);
+  _cell = cell;
+  columns = std::max(static_cast<int>(std::ceil(width / cell)), 1);
+  rows = std::max(static_cast<int>(std::ceil(height / cell)), 1);
+  auto stride = static_cast<std::size_t>(columns) + 1;
+  table.assign(stride * (static_cast<std::size_t>(rows) + 1), {});
+
+  // bin into the table shifted by one row and column, then sum up in place
+  Rect world(0.f, 0.f, width, height);
+  for (const Boid &boid : boids) {
+    Vec2 pos = boid.GetPosition();
+    if (!world.contains(pos)) continue;
+    auto column = std::min(static_cast<std::size_t>(pos.x / cell),
+                           static_cast<std::size_t>(columns) - 1);
+    auto row = std::min(static_cast<std::size_t>(pos.y / cell),
+                        static_cast<std::size_t>(rows) - 1);
+    AreaSums &sums = table[(row + 1) * stride + column + 1];
+    Vec2 vel = boid.GetVelocity();
+    ++sums.count;
+    sums.x += pos.x;
+    sums.y += pos.y;
+    sums.vx += vel.x;
+    sums.vy += vel.y;
+  }
+  for (std::size_t r = 1; r <= static_cast<std::size_t>(rows); ++r) {
+    for (std::size_t c = 1; c < stride; ++c) {
+      AreaSums &sums = table[r * stride + c];
+      const AreaSums &up = table[(r - 1) * stride + c];
+      const AreaSums &left = table[r * stride + c - 1];
+      const AreaSums &corner = table[(r - 1) * stride + c - 1];
+      sums.count += up.count + left.count - corner.count;
+      sums.x += up.x + left.x - corner.x;
+      sums.y += up.y + left.y - corner.y;
+      sums.vx += up.vx + left.vx - corner.vx;
+      sums.vy += up.vy + left.vy - corner.vy;
+    }
+  }
+}
+
+float SummedAreaGrid::GetCell() const { return _cell; }
+
+std::vector<CellBox> SummedAreaGrid::DiscBoxes(float radius) const {
+  assert(radius >= 0.f);
+  float reach = radius / _cell;
+  int last = static_cast<int>(reach);
+
+  std::vector<CellBox> boxes;
+  for (int dy = -last; dy <= last; ++dy) {
+    float dy2 = static_cast<float>(dy * dy);
+    int half = static_cast<int>(std::sqrt(reach * reach - dy2));
+    // a row as wide as the one above extends its box
+    if (!boxes.empty() && boxes.back().right == half) {
+      boxes.back().bottom = dy;
+    } else {
+      boxes.push_back({-half, dy, half, dy});
+    }
+  }
+  return boxes;
+}
+
+AreaSums SummedAreaGrid::Sum(Vec2 position,
+                             const std::vector<CellBox> &boxes) const {
+  auto column = static_cast<int>(std::floor(position.x / _cell));
+  auto row = static_cast<int>(std::floor(position.y / _cell));
+  AreaSums sum;
+  for (const CellBox &box : boxes) {
+    AreaSums part = Box(std::max(column + box.left, 0),
+                        std::max(row + box.top, 0),
+                        std::min(column + box.right, columns - 1),
+                        std::min(row + box.bottom, rows - 1));
+    sum.count += part.count;
+    sum.x += part.x;
+    sum.y += part.y;
+    sum.vx += part.vx;
+    sum.vy += part.vy;
+  }
+  return sum;
+}
+
+AreaSums SummedAreaGrid::Box(int left, int top, int right, int bottom) const {
+  if (left > right || top > bottom) return {};
+  auto stride = static_cast<std::size_t>(columns) + 1;
+  auto at = [&](int r, int c) -> const AreaSums & {
+    return table[static_cast<std::size_t>(r) * stride +
+                 static_cast<std::size_t>(c)];
+  };
+  const AreaSums &a = at(bottom + 1, right + 1);
+  const AreaSums &b = at(top, right + 1);
+  const AreaSums &c = at(bottom + 1, left);
+  const AreaSums &d = at(top, left);
+  return {a.count - b.count - c.count + d.count, a.x - b.x - c.x + d.x,
+          a.y - b.y - c.y + d.y, a.vx - b.vx - c.vx + d.vx,
+          a.vy - b.vy - c.vy + d.vy};
+}
@@ -0,0 +1,47 @@
+#ifndef SUMMED_AREA_HPP
+#define SUMMED_AREA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "boid.hpp"
+
+// number of the boids in a set of cells with the sums of their positions
+// and velocities; in double, a prefix sum over the whole world is large
+struct AreaSums {
+  std::uint32_t count = 0;
+  double x = 0.0, y = 0.0;
+  double vx = 0.0, vy = 0.0;
+};
+
+// inclusive range of cells, as offsets from a center cell
+struct CellBox {
+  int left, top, right, bottom;
+};
+
+// the boids of a world binned into square cells, with a summed-area table
+// (2D prefix sums) over them: the sums over any box of cells take four
+// reads, however many boids are in it. Boids outside the world are left out.
+class SummedAreaGrid {
+ public:
+  void Build(const std::vector<Boid> &boids, float width, float height,
+             float cell);
+
+  float GetCell() const;
+  // the cells whose center is within radius of the center of the middle
+  // cell, one box per run of rows of equal width
+  std::vector<CellBox> DiscBoxes(float radius) const;
+  // sums over the boxes around the cell of position
+  AreaSums Sum(Vec2 position, const std::vector<CellBox> &boxes) const;
+
+ private:
+  AreaSums Box(int left, int top, int right, int bottom) const;
+
+  float _cell = 1.f;
+  int columns = 0;
+  int rows = 0;
+  std::vector<AreaSums> table;  // (rows + 1) x (columns + 1), first ones 0
+};
+
+#endif
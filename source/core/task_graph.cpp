@@ -0,0 +1,81 @@
+#include "task_graph.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+
+TaskGraph::TaskId TaskGraph::Add(std::function<void()> work) {
+  assert(work);
+  tasks.push_back({std::move(work), {}, 0});
+  return tasks.size() - 1;
+}
+
+void TaskGraph::Precede(TaskId before, TaskId after) {
+  assert(before < tasks.size() && after < tasks.size() && before != after);
+  tasks[before].successors.push_back(after);
+  ++tasks[after].predecessors;
+}
+
+void TaskGraph::Clear() { tasks.clear(); }
+
+std::size_t TaskGraph::Size() const { return tasks.size(); }
+
+void TaskGraph::RunSerial() {
+  // Kahn's algorithm, running each task as it becomes ready
+  std::vector<std::size_t> pending(tasks.size());
+  std::vector<TaskId> ready;
+  for (TaskId id = 0; id < tasks.size(); ++id) {
+    pending[id] = tasks[id].predecessors;
+    if (pending[id] == 0) ready.push_back(id);
+  }
+
+  std::size_t done = 0;
+  while (!ready.empty()) {
+    TaskId id = ready.back();
+    ready.pop_back();
+    tasks[id].work();
+    ++done;
+    for (TaskId next : tasks[id].successors) {
+      if (--pending[next] == 0) ready.push_back(next);
+    }
+  }
+  assert(done == tasks.size() && "TaskGraph has a cycle");
+}
+
+void TaskGraph::Run(ThreadPool *pool) {
+  if (tasks.empty()) return;
+  if (pool == nullptr || pool->GetThreadCount() == 1) {
+    RunSerial();
+    return;
+  }
+
+  std::unique_ptr<std::atomic<std::size_t>[]> pending(
+      new std::atomic<std::size_t>[tasks.size()]);
+  for (TaskId id = 0; id < tasks.size(); ++id) {
+    pending[id].store(tasks[id].predecessors, std::memory_order_relaxed);
+  }
+  std::atomic<std::size_t> remaining{tasks.size()};
+
+  // a finished task releases the successors it was the last predecessor of
+  std::function<void(TaskId)> launch = [&](TaskId id) {
+    pool->Submit([&, id] {
+      tasks[id].work();
+      for (TaskId next : tasks[id].successors) {
+        if (pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          launch(next);
+        }
+      }
+      remaining.fetch_sub(1, std::memory_order_release);
+    });
+  };
+
+  for (TaskId id = 0; id < tasks.size(); ++id) {
+    if (tasks[id].predecessors == 0) launch(id);
+  }
+
+  // the caller helps instead of sleeping, which also lets tasks that run
+  // their own ParallelFor make progress on a busy pool
+  while (remaining.load(std::memory_order_acquire) > 0) {
+    if (!pool->RunPending()) std::this_thread::yield();
+  }
+}
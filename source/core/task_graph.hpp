@@ -0,0 +1,37 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+// set of tasks with "runs before" edges; Run() starts every task as soon as
+// all of its predecessors are done, so independent tasks overlap on the pool
+class TaskGraph {
+ public:
+  using TaskId = std::size_t;
+
+  TaskId Add(std::function<void()> work);
+  void Precede(TaskId before, TaskId after);
+  void Clear();
+  std::size_t Size() const;
+
+  // blocks until every task has run; without a pool (or with a single
+  // thread) the tasks run in a dependency respecting order on the caller
+  void Run(ThreadPool *pool);
+
+ private:
+  struct Task {
+    std::function<void()> work;
+    std::vector<TaskId> successors;
+    std::size_t predecessors = 0;
+  };
+
+  void RunSerial();
+
+  std::vector<Task> tasks;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  // the calling thread counts as one of the threads
+  std::size_t helpers = threads > 1 ? threads - 1 : 0;
+  workers.reserve(helpers);
+  for (std::size_t i = 0; i < helpers; ++i) {
+    workers.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread &worker : workers) worker.join();
+}
+
+std::size_t ThreadPool::GetThreadCount() const { return workers.size() + 1; }
+
+void ThreadPool::Submit(std::function<void()> task) {
+  assert(task);
+  if (workers.empty()) {
+    task();  // nobody else would ever run it
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+  wake.notify_one();
+}
+
+bool ThreadPool::RunPending() {
+  std::function<void()> task;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty()) return false;
+    task = std::move(tasks.front());
+    tasks.pop_front();
+  }
+  task();
+  return true;
+}
+
+void ThreadPool::ParallelFor(
+    std::size_t count, std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)> &body) {
+  if (count == 0) return;
+  grain = std::max<std::size_t>(grain, 1);
+  std::size_t chunks = (count + grain - 1) / grain;
+  if (chunks == 1 || workers.empty()) {
+    body(0, count);
+    return;
+  }
+
+  struct Progress {
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> finished{0};
+  };
+  auto progress = std::make_shared<Progress>();
+
+  // helpers that start late find no chunk left and never touch body
+  auto work = [progress, count, grain, chunks, &body] {
+    for (std::size_t c = progress->next.fetch_add(1); c < chunks;
+         c = progress->next.fetch_add(1)) {
+      std::size_t begin = c * grain;
+      body(begin, std::min(begin + grain, count));
+      progress->finished.fetch_add(1, std::memory_order_release);
+    }
+  };
+
+  std::size_t helpers = std::min(workers.size(), chunks - 1);
+  for (std::size_t i = 0; i < helpers; ++i) Submit(work);
+  work();
+
+  // help with other queued work instead of blocking, so nested calls and
+  // tasks waiting on each other cannot starve the pool
+  while (progress->finished.load(std::memory_order_acquire) < chunks) {
+    if (!RunPending()) std::this_thread::yield();
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (tasks.empty()) return;  // stopping and drained
+      task = std::move(tasks.front());
+      tasks.pop_front();
+    }
+    task();
+  }
+}
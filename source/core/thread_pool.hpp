@@ -0,0 +1,42 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads fed from a shared task queue; the thread that
+// calls ParallelFor works on the range too, so a pool of size 1 is serial
+class ThreadPool {
+ public:
+  explicit ThreadPool(
+      std::size_t threads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  std::size_t GetThreadCount() const;
+
+  void Submit(std::function<void()> task);
+  // runs body(begin, end) over [0, count) in chunks of grain elements and
+  // returns once every chunk is done
+  void ParallelFor(std::size_t count, std::size_t grain,
+                   const std::function<void(std::size_t, std::size_t)> &body);
+  // runs one queued task on the calling thread, false if there was none
+  bool RunPending();
+
+ private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> tasks;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+};
+
+#endif
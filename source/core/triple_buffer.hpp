@@ -0,0 +1,47 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// lock-free hand-over of whole states from one writer thread to one reader
+// thread: the writer fills its own buffer and publishes it by swapping it with
+// the shared middle one, the reader swaps the middle one with its own buffer
+// only when something new was published. Neither side ever waits.
+template <class T>
+class TripleBuffer {
+ public:
+  // writer side: buffer to fill, then Publish() it
+  T &WriteBuffer() { return buffers[writeIndex]; }
+  void Publish() {
+    std::uint8_t previous =
+        middle.exchange(static_cast<std::uint8_t>(writeIndex | freshBit),
+                        std::memory_order_acq_rel);
+    writeIndex = previous & indexMask;
+  }
+
+  // reader side: latest published state, valid until the next Read()
+  const T &Read() {
+    if (middle.load(std::memory_order_relaxed) & freshBit) {
+      std::uint8_t previous =
+          middle.exchange(readIndex, std::memory_order_acq_rel);
+      readIndex = previous & indexMask;
+    }
+    return buffers[readIndex];
+  }
+  bool HasFresh() const {
+    return (middle.load(std::memory_order_relaxed) & freshBit) != 0;
+  }
+
+ private:
+  static constexpr std::uint8_t indexMask = 0x3;
+  static constexpr std::uint8_t freshBit = 0x4;
+
+  std::array<T, 3> buffers{};
+  std::atomic<std::uint8_t> middle{1};
+  std::uint8_t writeIndex = 0;  // only touched by the writer
+  std::uint8_t readIndex = 2;   // only touched by the reader
+};
+
+#endif
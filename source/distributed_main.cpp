@@ -0,0 +1,51 @@
+#include <cstdlib>
+#include <iostream>
+
+#include "counter_rng.hpp"
+#include "domain.hpp"
+
+// headless run of one flock split over several processes, one vertical
+// strip of the world each; prints what every rank did
+//
+//   BoidDistributed [ranks] [boids] [steps]
+int main(int argc, char *argv[]) {
+  DomainSettings settings;
+  settings.width = 1600.f;
+  settings.height = 900.f;
+  settings.margin = settings.params.radius;
+  settings.ranks = 4;
+  std::size_t count = 2000;
+  if (argc > 1) settings.ranks = std::atoi(argv[1]);
+  if (argc > 2) count = std::strtoul(argv[2], nullptr, 10);
+  if (argc > 3) settings.steps = std::atoi(argv[3]);
+  if (settings.ranks < 1 || settings.steps < 0) {
+    std::cerr << "usage: BoidDistributed [ranks] [boids] [steps]\n";
+    return 1;
+  }
+
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(0, 0, count, {0.f, 0.f, settings.width, settings.height},
+               settings.params.maxSpeed, positions, velocities);
+  std::vector<BoidRecord> initial(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    initial[i].position = positions[i];
+    initial[i].velocity = velocities[i];
+  }
+
+  std::vector<BoidRecord> result;
+  std::vector<DomainStats> stats;
+  if (!RunDistributed(settings, initial, {}, result, &stats)) {
+    std::cerr << "distributed run failed (strips narrower than "
+                 "the rule radii, or a rank died)\n";
+    return 1;
+  }
+
+  std::cout << "rank\tboids\thalo\tmigrated\tbytes\tseconds\n";
+  for (std::size_t i = 0; i < stats.size(); ++i) {
+    std::cout << i << '\t' << stats[i].boids << '\t' << stats[i].haloSent
+              << '\t' << stats[i].migrated << '\t' << stats[i].bytesSent
+              << '\t' << stats[i].seconds << '\n';
+  }
+  std::cout << "total boids: " << result.size() << '\n';
+}
@@ -0,0 +1,70 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "ensemble.hpp"
+#include "lane_ensemble.hpp"
+
+// headless parameter sweep: runs every combination of the weights and radii
+// below concurrently and writes one summary row per run; --lanes packs the
+// worlds into SIMD lanes instead of giving each its own simulation
+//
+//   BoidEnsemble [--lanes] [boids] [steps] [seeds] [output.tsv]
+int main(int argc, char *argv[]) {
+  bool lanes = argc > 1 && std::string(argv[1]) == "--lanes";
+  if (lanes) {
+    --argc;
+    ++argv;
+  }
+
+  EnsembleSettings settings;
+  int seeds = 2;
+  if (argc > 1) settings.boids = std::strtoul(argv[1], nullptr, 10);
+  if (argc > 2) settings.steps = std::atoi(argv[2]);
+  if (argc > 3) seeds = std::atoi(argv[3]);
+  if (settings.steps < 0 || seeds < 1) {
+    std::cerr
+        << "usage: BoidEnsemble [--lanes] [boids] [steps] [seeds] [output]\n";
+    return 1;
+  }
+
+  // --- sweep: weights around the defaults, alignment radius factors ---
+  const float separations[] = {1e-4f, 3e-4f, 1e-3f};
+  const float cohesions[] = {3e-5f, 1e-4f, 3e-4f};
+  const float alignmentFactors[] = {10.f, 20.f, 30.f};
+
+  std::vector<EnsembleMember> members;
+  for (float separation : separations) {
+    for (float cohesion : cohesions) {
+      for (float factor : alignmentFactors) {
+        for (int seed = 0; seed < seeds; ++seed) {
+          EnsembleMember member;
+          member.weights.separation = separation;
+          member.weights.cohesion = cohesion;
+          member.params.SetRadii(5.f, 4.f, 10.f, factor);
+          member.seed = static_cast<std::uint32_t>(seed);
+          members.push_back(member);
+        }
+      }
+    }
+  }
+
+  ThreadPool pool;
+  std::cerr << "running " << members.size() << " simulations on "
+            << pool.GetThreadCount() << " threads\n";
+  std::vector<EnsembleSummary> summaries =
+      lanes ? RunLaneEnsemble(settings, members, &pool)
+            : RunEnsemble(settings, members, &pool);
+
+  if (argc > 4) {
+    std::ofstream file(argv[4]);
+    if (!file) {
+      std::cerr << "cannot write " << argv[4] << '\n';
+      return 1;
+    }
+    WriteSummaryTable(file, members, summaries);
+  } else {
+    WriteSummaryTable(std::cout, members, summaries);
+  }
+}
@@ -1,18 +1,27 @@
 #include <iostream>
+#include <random>
+#include <string>
+#include <utility>
 
-#include "evolution.hpp"
+#include "camera.hpp"
+#include "counter_rng.hpp"
 #include "menu.hpp"
-#include "quadtree.hpp"
+#include "renderer.hpp"
+#include "simulation.hpp"
 
 int main() {
   // --- window  ---
   sf::RenderWindow window(sf::VideoMode({800, 600}), "Boids Simulation");
   window.setFramerateLimit(120);
   sf::Vector2u windowlimits = window.getSize();
+  sf::Vector2f screenSize(static_cast<float>(windowlimits.x),
+                          static_cast<float>(windowlimits.y));
+
+  // --- simulated world, independent of the window and seen by a camera ---
   float minX = 0.0f;
-  float maxX = static_cast<float>(windowlimits.x);
+  float maxX = 2400.f;
   float minY = 0.0f;
-  float maxY = static_cast<float>(windowlimits.y);
+  float maxY = 1800.f;
 
   // --- various menus creation ---
   sf::Font font;
@@ -30,6 +39,8 @@ int main() {
   float defaultRad1 = 5.f;   // this is the standard multiplier
   float defaultRad2 = 10.f;  // this is the standard multiplier
   float defaultRad3 = 30.f;  // this is the standard multiplier
+  BoidParams boidParams;  // owned by each new simulation from here on
+  bool completeEvasion = false;
   BehaviorWeights weights;
   weights.separation = 0.4f;
   weights.cohesion = 0.1f;
@@ -41,19 +52,27 @@ int main() {
   const int maxObstacles{10};
   const int maxBoids{300};
 
+  // --- fixed simulation rate, independent of the display refresh ---
+  const float simulationRate{kReferenceRate};
+  const int maxStepsPerFrame{8};  // cap against the spiral of death
+
+  // --- level of detail switch points for large flocks ---
+  LodThresholds lodThresholds;
+  lodThresholds.pointBoids = 5000;
+  lodThresholds.cellBoids = 50000;
+
+  // --- worker threads shared by the simulation phases and the renderers ---
+  ThreadPool pool;
+
   // --- definition and standard setting for the arrow following mode ---
   bool mouseFollowMode = false;
 
-  // --- random generators: device, engines and distribiutions ---
-  std::random_device r;
-  std::default_random_engine e1(r());
-  std::uniform_int_distribution<int> present_dist(20, 300);
-  std::uniform_real_distribution<float> positionX_dist(minX + Radius,
-                                                       maxX - Radius);
-  std::uniform_real_distribution<float> positionY_dist(minY + Radius,
-                                                       maxY - Radius);
-  std::uniform_real_distribution<float> speedX_dist(-2, 2);
-  std::uniform_real_distribution<float> speedY_dist(-2, 2);
+  // --- random numbers: one seed per run, one stream per spawned boid ---
+  const std::uint64_t seed = std::random_device{}();
+  std::uint64_t nextBoidId = 0;
+  const Rect spawnArea(minX + Radius, minY + Radius, maxX - minX - 2 * Radius,
+                       maxY - minY - 2 * Radius);
+  const float spawnSpeed{2.f};  // per component, before the speed limit
 
   // --- main game loop ---
   while (window.isOpen()) {
@@ -85,15 +104,14 @@ int main() {
         float factor2 = activeMenu->wasSliderMoved("Cohesion Radius");
         float factor3 = activeMenu->wasSliderMoved("Alignment Radius");
 
-        Boid::SetRadii(Radius * factor0, defaultRad1 * factor1,
-                       defaultRad2 * factor2, defaultRad3 * factor3);
+        boidParams.SetRadii(Radius * factor0, defaultRad1 * factor1,
+                            defaultRad2 * factor2, defaultRad3 * factor3);
       }
       // --- modalities menu UI ---
       else if (activeMenu == &modalitiesMenu) {
-        Boid::setGradualDamage(
-            activeMenu->wasCheckBoxChecked("Gradual Damage"));
-        Obstacle::setCompleteEvasion(
-            activeMenu->wasCheckBoxChecked("Complete Evasion"));
+        boidParams.gradualDamage =
+            activeMenu->wasCheckBoxChecked("Gradual Damage");
+        completeEvasion = activeMenu->wasCheckBoxChecked("Complete Evasion");
         mouseFollowMode = activeMenu->wasCheckBoxChecked("Arrow Following");
       }
 
@@ -107,32 +125,47 @@ int main() {
     }
 
     Notification notification;  // for error messages or in-game warnings
-    std::vector<Boid> boids;
-    std::vector<Obstacle> obstacles;
+    Simulation simulation(maxX, maxY, Radius, weights, boidParams);
+    simulation.SetThreadPool(&pool);
+    simulation.SetCompleteEvasion(completeEvasion);
     bool obstacleMode = false;  // for obstacles generation
 
     // initial spawned boids vector filling
-    for (int i{1}; i <= spawnedBoids; i++) {
-      sf::Vector2f position{positionX_dist(e1), positionY_dist(e1)};
-      sf::Vector2f velocity{speedX_dist(e1), speedY_dist(e1)};
-      Boid new_Boid(position, velocity);
-      boids.push_back(std::move(new_Boid));
+    std::vector<Vec2> positions;
+    std::vector<Vec2> velocities;
+    SpawnUniform(seed, nextBoidId, static_cast<std::size_t>(spawnedBoids),
+                 spawnArea, spawnSpeed, positions, velocities, &pool);
+    nextBoidId += positions.size();
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      simulation.AddBoid(positions[i], velocities[i]);
     }
 
-    // first standard tree creation
-    Quadtree tree(0.f, 0.f, static_cast<float>(windowlimits.x),
-                  static_cast<float>(windowlimits.y), 4);
+    Camera camera(screenSize, simulation.GetWorldBounds());
+    BoidRenderer boidRenderer(&pool, lodThresholds);
+
+    // head-up display with the rendering level of detail
+    sf::Text hud;
+    hud.setFont(font);
+    hud.setCharacterSize(14);
+    hud.setFillColor(sf::Color::White);
+    hud.setPosition(10.f, screenSize.y - 24.f);
 
-    // clock for collisions timers
-    sf::Clock deltaClock;
+    // from here on the simulation belongs to its own thread, reached only
+    // through commands, and is seen only through its snapshots
+    SimulationRunner runner(simulation, 1.f / simulationRate,
+                            maxStepsPerFrame);
+    runner.Start();
+    const FrameSnapshot *latest = &runner.AcquireSnapshot();
 
-    // --- boid simulation loop / game loop ---
+    // --- render loop / game loop ---
     while (window.isOpen() && activeMenu->startState()) {
       sf::Event event;
-      float dt = deltaClock.restart().asSeconds();
+      const FrameSnapshot &snapshot = *latest;
 
       // --- events list ---
       while (window.pollEvent(event)) {
+        camera.handleEvent(event, window);
+
         switch (event.type) {
           case sf::Event::Closed:
             window.close();
@@ -141,21 +174,24 @@ int main() {
           case sf::Event::MouseButtonPressed:
             // --- boid and obstacle creation from mouse up to fixed limits
             if (event.mouseButton.button == sf::Mouse::Left) {
-              sf::Vector2f position(static_cast<float>(event.mouseButton.x),
-                                    static_cast<float>(event.mouseButton.y));
+              Vec2 position = FromSf(window.mapPixelToCoords(
+                  {event.mouseButton.x, event.mouseButton.y},
+                  camera.getView()));
 
               if (obstacleMode) {
-                if (obstacles.size() < maxObstacles) {
+                if (snapshot.totalObstacles < maxObstacles) {
                   float obstacleSide = 40.f;
-                  obstacles.emplace_back(position, obstacleSide);
+                  runner.Send(Command::PlaceObstacle(position, obstacleSide));
                 } else {
                   notification.show("Max obstacles reached!", font,
                                     {20.f, 20.f});
                 }
               } else {
-                if (boids.size() < maxBoids) {
-                  sf::Vector2f velocity(speedX_dist(e1), speedY_dist(e1));
-                  boids.emplace_back(position, velocity);
+                if (snapshot.totalBoids < maxBoids) {
+                  CounterRng rng(seed, nextBoidId++);
+                  Vec2 velocity(rng.Uniform(-spawnSpeed, spawnSpeed),
+                                rng.Uniform(-spawnSpeed, spawnSpeed));
+                  runner.Send(Command::SpawnBoid(position, velocity));
                 } else {
                   notification.show("Max boids reached!", font, {20.f, 50.f});
                 }
@@ -186,8 +222,9 @@ int main() {
               }
             }
             if (event.key.code == sf::Keyboard::E) {
-              Obstacle::AlterEvasionState();
-              if (Obstacle::GetEvasionState()) {
+              completeEvasion = !completeEvasion;
+              runner.Send(Command::SetEvasion(completeEvasion));
+              if (completeEvasion) {
                 notification.show("Obstacle Evasion Enabled", font,
                                   {20.f, 20.f});
               } else {
@@ -210,70 +247,36 @@ int main() {
         }
       }
 
-      window.clear();
-      tree.clear();
-
-      notification.draw(window);  // this can be positioned also elsewhere, it
-                                  // suffices after event list
-
-      // insertion of boids into quadtree
-      for (Boid &boid : boids) {
-        tree.insert(&boid);
-      }
-
-      // --- mouse following data ---
-      sf::Vector2i mousePixel = sf::Mouse::getPosition(window);
-      sf::Vector2f mousePos(static_cast<float>(mousePixel.x),
-                            static_cast<float>(mousePixel.y));
-
-      // --- obstacles loop ---
-      std::vector<Obstacle *> obstacle_ptrs;
-      obstacle_ptrs.reserve(obstacles.size());
-      for (Obstacle &obs : obstacles) {
-        obstacle_ptrs.push_back(&obs);
-        window.draw(obs.GetShape());
-      }
-
-      // --- boids main loop ---
-      for (Boid &boid : boids) {
-        float maxRadius = std::max(
-            {boid.GetRadiusSep(), boid.GetRadiusCoh(), boid.GetRadiusAlg()});
-        sf::Vector2f pos = boid.GetPosition();
-        sf::FloatRect queryRange(pos.x - maxRadius, pos.y - maxRadius,
-                                 2 * maxRadius, 2 * maxRadius);
-
-        std::vector<Boid *> neighbors;
-        tree.query(queryRange,
-                   neighbors);  // restriction to closer boids through quadtree
-
-        Evolution(boid, neighbors, obstacle_ptrs, maxX, maxY, Radius, weights,
-                  mouseFollowMode, mousePos);
-
-        window.draw(boid.GetShape());
-      }
-
-      // ------ collision loops -------
-      for (auto boidIt = boids.begin(); boidIt != boids.end();) {
-        bool collided = false;
+      // --- mouse following data and area to copy into the snapshots; the
+      // margin keeps boids crossing the border of the view ---
+      Vec2 mousePos = FromSf(window.mapPixelToCoords(
+          sf::Mouse::getPosition(window), camera.getView()));
+      runner.Send(Command::SetMouseFollow(mouseFollowMode, mousePos));
 
-        for (Obstacle &obstacle : obstacles) {
-          if (obstacle.CollisionResponse(*boidIt)) {
-            collided = true;
-            break;
-          }
-        }
-
-        if (collided) {
-          bool shouldDestroy = boidIt->UpdateHit(dt);
+      Rect visible = camera.getVisibleArea();
+      runner.Send(Command::SetViewArea(
+          Rect(visible.left - Radius, visible.top - Radius,
+               visible.width + 2 * Radius, visible.height + 2 * Radius)));
 
-          if (shouldDestroy) {
-            boidIt = boids.erase(boidIt);
-            continue;
-          }
-        }
+      // --- drawing of the latest state, interpolated between its last two
+      // steps ---
+      latest = &runner.AcquireSnapshot();
+      float alpha = latest->AlphaAt(std::chrono::steady_clock::now());
 
-        ++boidIt;
-      }
+      window.clear();
+      window.setView(camera.getView());
+      DrawObstacles(window, latest->obstacles);
+      boidRenderer.draw(window, latest->boids, latest->boidRadius, alpha);
+
+      // --- screen-space overlays, also leaving the default view to menus ---
+      window.setView(window.getDefaultView());
+      notification.draw(window);
+
+      hud.setString(std::to_string(latest->boids.size()) + "/" +
+                    std::to_string(latest->totalBoids) +
+                    " boids drawn - LOD: " +
+                    LodModeName(boidRenderer.getMode()));
+      window.draw(hud);
 
       window.display();
     }
@@ -0,0 +1,232 @@
+#include "renderer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+//------conversions-------
+
+sf::Vector2f ToSf(Vec2 vec) { return {vec.x, vec.y}; }
+Vec2 FromSf(sf::Vector2f vec) { return {vec.x, vec.y}; }
+sf::FloatRect ToSf(const Rect &rect) {
+  return {rect.left, rect.top, rect.width, rect.height};
+}
+
+sf::Color DamageColor(int damage) {
+  if (damage >= 3) return sf::Color::Red;
+  if (damage == 2) return sf::Color(255, 165, 0);
+  if (damage == 1) return sf::Color::Yellow;
+  return sf::Color::White;
+}
+
+//------boids-------
+
+const char *LodModeName(LodMode mode) {
+  switch (mode) {
+    case LodMode::Triangles:
+      return "triangles";
+    case LodMode::Points:
+      return "points";
+    case LodMode::Cells:
+      return "density cells";
+  }
+  return "";
+}
+
+BoidRenderer::BoidRenderer(ThreadPool *pool, const LodThresholds &thresholds)
+    : vertices(sf::Triangles), _pool(pool), _thresholds(thresholds) {
+  assert(thresholds.cellPixels > 0);
+}
+
+void BoidRenderer::setThresholds(const LodThresholds &thresholds) {
+  assert(thresholds.cellPixels > 0);
+  _thresholds = thresholds;
+}
+
+LodMode BoidRenderer::getMode() const { return mode; }
+
+LodMode BoidRenderer::selectMode(const sf::RenderTarget &target,
+                                 std::size_t count, float radius) const {
+  if (count == 0) return LodMode::Triangles;
+
+  // on-screen size of a boid with the current view, i.e. the zoom level
+  float pixelsPerUnit = static_cast<float>(target.getSize().x) /
+                        target.getView().getSize().x;
+  float boidPixels = radius * pixelsPerUnit;
+
+  if (count >= _thresholds.cellBoids ||
+      boidPixels < _thresholds.minPointPixels) {
+    return LodMode::Cells;
+  }
+  if (count >= _thresholds.pointBoids ||
+      boidPixels < _thresholds.minTrianglePixels) {
+    return LodMode::Points;
+  }
+  return LodMode::Triangles;
+}
+
+void BoidRenderer::forEachChunk(
+    std::size_t count,
+    const std::function<void(std::size_t, std::size_t)> &body) {
+  if (_pool != nullptr && count > parallelGrain) {
+    _pool->ParallelFor(count, parallelGrain, body);
+  } else {
+    body(0, count);
+  }
+}
+
+void BoidRenderer::fillTriangles(const std::vector<BoidSnapshot> &boids,
+                                 float radius, float alpha, std::size_t begin,
+                                 std::size_t end) {
+  // triangle vertices at 120 degrees from each other, the tip along the
+  // heading: cos(120) = -1/2 and sin(120) = sqrt(3)/2 avoid any trig call
+  constexpr float cos120 = -0.5f;
+  constexpr float sin120 = 0.8660254f;
+
+  for (std::size_t i = begin; i < end; ++i) {
+    const BoidSnapshot &boid = boids[i];
+    Vec2 prev = boid.previousPosition;
+    Vec2 pos = prev + (boid.position - prev) * alpha;
+
+    Vec2 vel = boid.velocity;
+    float speed = Norm(vel);
+    Vec2 heading = speed > 0.001f ? vel / speed : Vec2{0.f, -1.f};
+    Vec2 side{-heading.y, heading.x};
+
+    Vec2 tip = heading * radius;
+    Vec2 left = (heading * cos120 + side * sin120) * radius;
+    Vec2 right = (heading * cos120 - side * sin120) * radius;
+
+    sf::Color colour = DamageColor(boid.damage);
+    sf::Vertex *triangle = &vertices[3 * i];
+    triangle[0] = sf::Vertex(ToSf(pos + tip), colour);
+    triangle[1] = sf::Vertex(ToSf(pos + left), colour);
+    triangle[2] = sf::Vertex(ToSf(pos + right), colour);
+  }
+}
+
+void BoidRenderer::fillPoints(const std::vector<BoidSnapshot> &boids,
+                              float alpha, std::size_t begin,
+                              std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    const BoidSnapshot &boid = boids[i];
+    Vec2 prev = boid.previousPosition;
+    Vec2 pos = prev + (boid.position - prev) * alpha;
+    vertices[i] = sf::Vertex(ToSf(pos), DamageColor(boid.damage));
+  }
+}
+
+void BoidRenderer::drawCells(sf::RenderTarget &target,
+                             const std::vector<BoidSnapshot> &boids,
+                             float alpha) {
+  // one cell every cellPixels screen pixels over the visible area
+  const sf::View &view = target.getView();
+  sf::Vector2u screen = target.getSize();
+  unsigned columns = std::max(1u, screen.x / _thresholds.cellPixels);
+  unsigned rows = std::max(1u, screen.y / _thresholds.cellPixels);
+  sf::Vector2f origin = view.getCenter() - view.getSize() / 2.f;
+  float cellWidth = view.getSize().x / static_cast<float>(columns);
+  float cellHeight = view.getSize().y / static_cast<float>(rows);
+
+  cellCounts.assign(static_cast<std::size_t>(columns) * rows, 0);
+  unsigned densest = 0;
+  for (const BoidSnapshot &boid : boids) {
+    Vec2 prev = boid.previousPosition;
+    Vec2 pos = prev + (boid.position - prev) * alpha;
+    float cx = (pos.x - origin.x) / cellWidth;
+    float cy = (pos.y - origin.y) / cellHeight;
+    if (cx < 0.f || cy < 0.f || cx >= static_cast<float>(columns) ||
+        cy >= static_cast<float>(rows)) {
+      continue;  // outside the view
+    }
+    std::size_t cell = static_cast<std::size_t>(cy) * columns +
+                       static_cast<std::size_t>(cx);
+    densest = std::max(densest, ++cellCounts[cell]);
+  }
+
+  // square root shading keeps sparse cells visible next to dense clumps
+  cellPixels.resize(cellCounts.size() * 4);
+  float scale = densest > 0 ? 1.f / std::sqrt(static_cast<float>(densest))
+                            : 0.f;
+  forEachChunk(cellCounts.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      float shade = std::sqrt(static_cast<float>(cellCounts[i])) * scale;
+      auto level = static_cast<sf::Uint8>(255.f * shade);
+      cellPixels[4 * i + 0] = level;
+      cellPixels[4 * i + 1] = level;
+      cellPixels[4 * i + 2] = level;
+      cellPixels[4 * i + 3] = level;
+    }
+  });
+
+  if (textureSize != sf::Vector2u(columns, rows)) {
+    cellTexture.create(columns, rows);
+    textureSize = {columns, rows};
+  }
+  cellTexture.update(cellPixels.data());
+
+  sf::Sprite sprite(cellTexture);
+  sprite.setPosition(origin);
+  sprite.setScale(cellWidth, cellHeight);
+  target.draw(sprite);
+}
+
+void BoidRenderer::draw(sf::RenderTarget &target,
+                        const std::vector<BoidSnapshot> &boids, float radius,
+                        float alpha) {
+  assert(alpha >= 0.f && alpha <= 1.f);
+  mode = selectMode(target, boids.size(), radius);
+
+  switch (mode) {
+    case LodMode::Triangles:
+      vertices.setPrimitiveType(sf::Triangles);
+      vertices.resize(3 * boids.size());
+      forEachChunk(boids.size(), [&](std::size_t begin, std::size_t end) {
+        fillTriangles(boids, radius, alpha, begin, end);
+      });
+      target.draw(vertices);
+      break;
+    case LodMode::Points:
+      vertices.setPrimitiveType(sf::Points);
+      vertices.resize(boids.size());
+      forEachChunk(boids.size(), [&](std::size_t begin, std::size_t end) {
+        fillPoints(boids, alpha, begin, end);
+      });
+      target.draw(vertices);
+      break;
+    case LodMode::Cells:
+      drawCells(target, boids, alpha);
+      break;
+  }
+}
+
+//------obstacles and tree-------
+
+void DrawObstacles(sf::RenderTarget &target,
+                   const std::vector<Rect> &obstacles) {
+  sf::RectangleShape rectShape;
+  rectShape.setFillColor(sf::Color::Blue);
+  for (const Rect &bounds : obstacles) {
+    assert(bounds.width > 0 && bounds.height > 0);
+    rectShape.setPosition(bounds.left, bounds.top);
+    rectShape.setSize({bounds.width, bounds.height});
+    target.draw(rectShape);
+  }
+}
+
+void DrawQuadtree(sf::RenderTarget &target, const Quadtree &tree) {
+  sf::RectangleShape rectShape;
+  rectShape.setPosition(sf::Vector2f(tree.boundary.left, tree.boundary.top));
+  rectShape.setSize({tree.boundary.width, tree.boundary.height});
+  rectShape.setFillColor(sf::Color::Transparent);
+  rectShape.setOutlineThickness(1.f);
+  rectShape.setOutlineColor(sf::Color::Green);
+  target.draw(rectShape);
+
+  if (tree.divided) {
+    DrawQuadtree(target, *tree.northeast);
+    DrawQuadtree(target, *tree.northwest);
+    DrawQuadtree(target, *tree.southeast);
+    DrawQuadtree(target, *tree.southwest);
+  }
+}
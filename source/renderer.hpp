@@ -0,0 +1,82 @@
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <vector>
+
+#include "quadtree.hpp"
+#include "simulation_runner.hpp"
+#include "thread_pool.hpp"
+
+// ---- CORE <-> SFML CONVERSIONS ---
+
+sf::Vector2f ToSf(Vec2 vec);
+Vec2 FromSf(sf::Vector2f vec);
+sf::FloatRect ToSf(const Rect &rect);
+
+// colour of a boid for each of the damage stages
+sf::Color DamageColor(int damage);
+
+// ---- RENDERERS ---
+
+// level of detail used to draw the flock
+enum class LodMode { Triangles, Points, Cells };
+
+const char *LodModeName(LodMode mode);
+
+// switch points between the levels of detail, on flock size and on how big a
+// boid appears on screen
+struct LodThresholds {
+  std::size_t pointBoids = 5000;  // from here on boids are single points
+  std::size_t cellBoids = 50000;  // from here on only a density image
+  float minTrianglePixels = 1.5f;  // smaller boids on screen become points
+  float minPointPixels = 0.25f;    // smaller boids on screen become cells
+  unsigned cellPixels = 4;         // side of one density cell on screen
+};
+
+// all boids go into one vertex array (or one texture for the density cells),
+// submitted with one draw call
+class BoidRenderer {
+ public:
+  // with a pool, large flocks fill the vertex array in parallel
+  explicit BoidRenderer(ThreadPool *pool = nullptr,
+                        const LodThresholds &thresholds = {});
+
+  // alpha in [0, 1] interpolates between the previous and current positions
+  void draw(sf::RenderTarget &target, const std::vector<BoidSnapshot> &boids,
+            float radius, float alpha = 1.f);
+
+  void setThresholds(const LodThresholds &thresholds);
+  LodMode getMode() const;  // mode used by the last draw
+
+ private:
+  LodMode selectMode(const sf::RenderTarget &target, std::size_t count,
+                     float radius) const;
+  void forEachChunk(std::size_t count,
+                    const std::function<void(std::size_t, std::size_t)> &body);
+  void fillTriangles(const std::vector<BoidSnapshot> &boids, float radius,
+                     float alpha, std::size_t begin, std::size_t end);
+  void fillPoints(const std::vector<BoidSnapshot> &boids, float alpha,
+                  std::size_t begin, std::size_t end);
+  void drawCells(sf::RenderTarget &target,
+                 const std::vector<BoidSnapshot> &boids, float alpha);
+
+  sf::VertexArray vertices;
+  ThreadPool *_pool;
+  LodThresholds _thresholds;
+  LodMode mode = LodMode::Triangles;
+  static constexpr std::size_t parallelGrain = 2048;  // boids per chunk
+
+  //------density cells-------
+  std::vector<unsigned> cellCounts;
+  std::vector<sf::Uint8> cellPixels;
+  sf::Texture cellTexture;
+  sf::Vector2u textureSize;
+};
+
+void DrawObstacles(sf::RenderTarget &target,
+                   const std::vector<Rect> &obstacles);
+void DrawQuadtree(sf::RenderTarget &target, const Quadtree &tree);
+
+#endif
@@ -1,13 +1,30 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <sstream>
+
 #include "doctest.h"
+#include "cost_model.hpp"
+#include "counter_rng.hpp"
+#ifdef BOID_HAS_DISTRIBUTED
+#include <thread>
+
+#include "domain.hpp"
+#endif
+#include "ensemble.hpp"
 #include "evolution.hpp"
+#include "fixed_flock.hpp"
+#include "lane_ensemble.hpp"
 #include "quadtree.hpp"
+#include "simulation.hpp"
+#include "simulation_runner.hpp"
+#include "summed_area.hpp"
+#include "task_graph.hpp"
+#include "thread_pool.hpp"
 
 static constexpr float EPS = 1e-4f;
 
 TEST_CASE("Boid Position and Velocity Initialization") {
-  sf::Vector2f position(100.f, 150.f);
-  sf::Vector2f velocity(0.01f, 0.02f);
+  Vec2 position(100.f, 150.f);
+  Vec2 velocity(0.01f, 0.02f);
   Boid boid(position, velocity);
 
   CHECK(boid.GetPosition() == position);
@@ -15,11 +32,12 @@ TEST_CASE("Boid Position and Velocity Initialization") {
 }
 
 TEST_CASE("SpeedChange respects max speed limit") {
-  Boid::SetRadii(10.f, 3.f, 5.f, 8.f);  // also sets radius
-  Boid boid({0.f, 0.f}, {0.0f, 0.0f});
-  boid.SetMaxSpeed(0.03f);
+  BoidParams params;
+  params.SetRadii(10.f, 3.f, 5.f, 8.f);  // also sets radius
+  params.maxSpeed = 0.03f;
+  Boid boid({0.f, 0.f}, {0.0f, 0.0f}, &params);
 
-  sf::Vector2f fastVec = {1.f, 1.f};  // Clearly faster than _maxSpeed
+  Vec2 fastVec = {1.f, 1.f};  // Clearly faster than _maxSpeed
   boid.SpeedChange(fastVec);
 
   float speed = Norm(boid.GetVelocity());
@@ -27,17 +45,39 @@ TEST_CASE("SpeedChange respects max speed limit") {
 }
 
 TEST_CASE("Norm and Dot Product utilities work correctly") {
-  sf::Vector2f a = {3.f, 4.f};
-  sf::Vector2f b = {1.f, 2.f};
+  Vec2 a = {3.f, 4.f};
+  Vec2 b = {1.f, 2.f};
 
   CHECK(Norm(a) == doctest::Approx(5.f));
   CHECK((a * b) == doctest::Approx(11.f));
 }
 
+TEST_CASE("Vector math is usable at compile time") {
+  static_assert(Vec2{3.f, 4.f} * Vec2{1.f, 2.f} == 11.f);
+  static_assert(DistSqr({1.f, 1.f}, {4.f, 5.f}) == 25.f);
+  static_assert(Norm({3.f, 4.f}) == 5.f);
+  static_assert(Norm({0.f, 0.f}) == 0.f);
+  CHECK(Norm({1e-3f, 2.f}) == std::sqrt(1e-6f + 4.f));
+}
+
+TEST_CASE("Fast reciprocal square root stays close to the exact one") {
+  // over many octaves, both exponent parities of the estimate table
+  float worst = 0.f;
+  for (float x = 1e-12f; x < 1e12f; x *= 1.0137f) {
+    float exact = 1.f / std::sqrt(x);
+    worst = std::max(worst, std::abs(RSqrtFast(x) - exact) / exact);
+  }
+  CHECK(worst < 1e-6f);
+
+  Vec2 v{-3e-3f, 7e-2f};
+  CHECK(Norm(Normalized(v)) == doctest::Approx(1.f).epsilon(1e-6));
+}
+
 TEST_CASE("Boid SetRadii applies correct radii") {
-  Boid::SetRadii(10.f, 2.f, 4.f, 6.f);
+  BoidParams params;
+  params.SetRadii(10.f, 2.f, 4.f, 6.f);
 
-  Boid boid({0.f, 0.f}, {0.f, 0.f});
+  Boid boid({0.f, 0.f}, {0.f, 0.f}, &params);
   CHECK(boid.GetRadius() == doctest::Approx(10.f));
   CHECK(boid.GetRadiusSep() == doctest::Approx(20.f));
   CHECK(boid.GetRadiusCoh() == doctest::Approx(40.f));
@@ -49,14 +89,15 @@ TEST_CASE("Boid Damage and Hit Logic") {
 }  // and ??? how do i check this???
 
 TEST_CASE("Separation vector behaves correctly") {
-  Boid center({0.f, 0.f}, {0.f, 0.f});
-  Boid close1({5.f, 0.f}, {0.f, 0.f});
-  Boid close2({-5.f, 0.f}, {0.f, 0.f});
-  Boid far({100.f, 100.f}, {0.f, 0.f});
+  BoidParams params;
+  params.SetRadii(10.f, 2.f, 3.f,
+                  4.f);  // make sure sep radius covers close1 and close2
+  Boid center({0.f, 0.f}, {0.f, 0.f}, &params);
+  Boid close1({5.f, 0.f}, {0.f, 0.f}, &params);
+  Boid close2({-5.f, 0.f}, {0.f, 0.f}, &params);
+  Boid far({100.f, 100.f}, {0.f, 0.f}, &params);
 
   std::vector<Boid *> boids = {&center, &close1, &close2, &far};
-  Boid::SetRadii(10.f, 2.f, 3.f,
-                 4.f);  // make sure sep radius covers close1 and close2
 
   auto sep = SepSpeed(&center, boids);
   CHECK(sep.x == doctest::Approx(0.0f));
@@ -69,8 +110,8 @@ TEST_CASE("Obstacle bounds and initial state") {
   CHECK(b.width == doctest::Approx(20.f));
   CHECK(b.height == doctest::Approx(20.f));
   // center should be at position {50,50}
-  CHECK(o.GetShape().getPosition().x == doctest::Approx(50.f));
-  CHECK(o.GetShape().getPosition().y == doctest::Approx(50.f));
+  CHECK(o.GetPosition().x == doctest::Approx(50.f));
+  CHECK(o.GetPosition().y == doctest::Approx(50.f));
 }
 
 TEST_CASE("CollisionResponse detects overlap") {
@@ -82,11 +123,9 @@ TEST_CASE("CollisionResponse detects overlap") {
 
 TEST_CASE("CollisionResponse respects evasion mode") {
   Boid b({150.f, 150.f}, {0.f, 0.f});
-  Obstacle::AlterEvasionState();  // turn evasion ON
   Obstacle o({150.f, 150.f}, 30.f);
-  CHECK(o.CollisionResponse(b) == false);
-  // reset for other tests
-  Obstacle::AlterEvasionState();
+  CHECK(o.CollisionResponse(b, true) == false);  // evasion ON
+  CHECK(o.CollisionResponse(b, false) == true);
 }
 
 TEST_CASE("CollisionResponse no-collision when far") {
@@ -116,6 +155,81 @@ TEST_CASE("Insert and query basic") {
   CHECK(found[0] == &b1);
 }
 
+TEST_CASE("Quadtree aggregates count the boids within the radius") {
+  Quadtree qt(0, 0, 100, 100, 2);
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(3, 0, 400, {0.f, 0.f, 100.f, 100.f}, 1.f, positions,
+               velocities);
+  std::vector<Boid> boids;
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    boids.emplace_back(positions[i], velocities[i]);
+  }
+  for (Boid &b : boids) qt.insert(&b);
+  qt.summarize();
+  CHECK(qt.total.count == boids.size());
+
+  Vec2 center = boids[0].GetPosition();
+  BoidAggregate brute;
+  for (std::size_t i = 1; i < boids.size(); ++i) {
+    if (DistSqr(boids[i].GetPosition(), center) <= 30.f * 30.f) {
+      ++brute.count;
+      brute.position += boids[i].GetPosition();
+      brute.velocity += boids[i].GetVelocity();
+    }
+  }
+
+  BoidAggregate exact;
+  qt.aggregate(center, 30.f, 0.f, &boids[0], exact);
+  CHECK(exact.count == brute.count);
+  CHECK(exact.position.x == doctest::Approx(brute.position.x));
+  CHECK(exact.position.y == doctest::Approx(brute.position.y));
+  CHECK(exact.velocity.x == doctest::Approx(brute.velocity.x));
+  CHECK(exact.velocity.y == doctest::Approx(brute.velocity.y));
+
+  // whole small nodes at the rim: the count is only about right
+  BoidAggregate rough;
+  qt.aggregate(center, 30.f, 0.5f, &boids[0], rough);
+  CHECK(static_cast<float>(rough.count) ==
+        doctest::Approx(static_cast<float>(brute.count)).epsilon(0.1));
+}
+
+TEST_CASE("Summed-area grid sums the cells of a disc") {
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(5, 0, 500, {0.f, 0.f, 100.f, 80.f}, 1.f, positions,
+               velocities);
+  std::vector<Boid> boids;
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    boids.emplace_back(positions[i], velocities[i]);
+  }
+  boids.emplace_back(Vec2{-2.f, 40.f}, Vec2{});  // outside, never counted
+  SummedAreaGrid grid;
+  grid.Build(boids, 100.f, 80.f, 5.f);
+
+  // whole cells whose center is within the radius of the middle one, cut
+  // by the world border
+  float reach = 23.f / 5.f;
+  for (Vec2 center : {Vec2{50.f, 40.f}, Vec2{3.f, 77.f}, Vec2{-4.f, 10.f}}) {
+    int column = static_cast<int>(std::floor(center.x / 5.f));
+    int row = static_cast<int>(std::floor(center.y / 5.f));
+    AreaSums brute;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      int dx = static_cast<int>(positions[i].x / 5.f) - column;
+      int dy = static_cast<int>(positions[i].y / 5.f) - row;
+      if (static_cast<float>(dx * dx + dy * dy) <= reach * reach) {
+        ++brute.count;
+        brute.x += positions[i].x;
+        brute.vy += velocities[i].y;
+      }
+    }
+    AreaSums sum = grid.Sum(center, grid.DiscBoxes(23.f));
+    CHECK(sum.count == brute.count);
+    CHECK(sum.x == doctest::Approx(brute.x));
+    CHECK(sum.vy == doctest::Approx(brute.vy));
+  }
+}
+
 TEST_CASE("Obstacle construction with positive size") {
   Obstacle o({50, 50}, 20.f);
   CHECK(o.GetBounds().width == doctest::Approx(20.f));
@@ -124,17 +238,15 @@ TEST_CASE("Obstacle construction with positive size") {
 
 TEST_CASE("Obstacle origin is centered") {
   Obstacle o({0, 0}, 10.f);
-  auto origin = o.GetShape().getOrigin();
-  CHECK(origin.x == doctest::Approx(5.f));
-  CHECK(origin.y == doctest::Approx(5.f));
+  auto bounds = o.GetBounds();
+  CHECK(bounds.left + bounds.width / 2.f == doctest::Approx(0.f));
+  CHECK(bounds.top + bounds.height / 2.f == doctest::Approx(0.f));
 }
 
 TEST_CASE("CollisionResponse returns false when evasion ON") {
-  Obstacle::AlterEvasionState();  // turn ON
   Boid b({5, 5}, {0, 0});
   Obstacle o({0, 0}, 10.f);
-  CHECK(o.CollisionResponse(b) == false);
-  Obstacle::AlterEvasionState();  // reset
+  CHECK(o.CollisionResponse(b, true) == false);
 }
 
 TEST_CASE("CollisionResponse detects overlap") {
@@ -187,3 +299,1038 @@ TEST_CASE("Obstacle::RepelBoid produces correct repulsion strength") {
   CHECK(repel.x == doctest::Approx(1.f).epsilon(EPS));
   CHECK(repel.y == doctest::Approx(0.f).epsilon(EPS));
 }
+
+TEST_CASE("FixedTimestep runs whole steps and keeps the remainder") {
+  FixedTimestep timestep(0.01f, 5);
+  CHECK(timestep.Advance(0.025f) == 2);
+  CHECK(timestep.GetAlpha() == doctest::Approx(0.5f).epsilon(1e-3));
+  CHECK(timestep.Advance(0.005f) == 1);
+  CHECK(timestep.GetAlpha() == doctest::Approx(0.f).epsilon(1e-3));
+}
+
+TEST_CASE("FixedTimestep caps the steps of a slow frame") {
+  FixedTimestep timestep(0.01f, 3);
+  CHECK(timestep.Advance(1.f) == 3);  // backlog dropped, not carried over
+  CHECK(timestep.GetAlpha() < 1.f);
+  CHECK(timestep.Advance(0.f) == 0);
+}
+
+TEST_CASE("Update_Position integrates with an explicit dt") {
+  Boid boid({0.f, 0.f}, {0.2f, 0.f});
+  boid.Update_Position(kReferenceStep / 2.f);
+  boid.Update_Position(kReferenceStep / 2.f);
+  CHECK(boid.GetPosition().x == doctest::Approx(0.2f).epsilon(EPS));
+  CHECK(boid.GetPreviousPosition().x == doctest::Approx(0.1f).epsilon(EPS));
+}
+
+TEST_CASE("Simulation motion does not depend on the step rate") {
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 30.f);
+  BehaviorWeights weights;
+  Simulation coarse(800.f, 600.f, 5.f, weights, params);
+  Simulation fine(800.f, 600.f, 5.f, weights, params);
+  coarse.AddBoid({100.f, 100.f}, {0.1f, 0.05f});
+  fine.AddBoid({100.f, 100.f}, {0.1f, 0.05f});
+
+  for (int i = 0; i < 10; ++i) coarse.Step(kReferenceStep);
+  for (int i = 0; i < 40; ++i) fine.Step(kReferenceStep / 4.f);
+
+  Vec2 a = coarse.GetBoids()[0].GetPosition();
+  Vec2 b = fine.GetBoids()[0].GetPosition();
+  CHECK(a.x == doctest::Approx(b.x).epsilon(EPS));
+  CHECK(a.y == doctest::Approx(b.y).epsilon(EPS));
+}
+
+TEST_CASE("ThreadPool ParallelFor covers every index exactly once") {
+  ThreadPool pool(4);
+  CHECK(pool.GetThreadCount() == 4);
+
+  std::vector<int> hits(10007, 0);
+  pool.ParallelFor(hits.size(), 100, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) ++hits[i];
+  });
+  CHECK(std::count(hits.begin(), hits.end(), 1) ==
+        static_cast<long>(hits.size()));
+
+  ThreadPool serial(1);
+  int calls = 0;
+  serial.ParallelFor(50, 10, [&](std::size_t, std::size_t) { ++calls; });
+  CHECK(calls == 1);  // no helper threads, the whole range at once
+}
+
+TEST_CASE("Simulation culling queries find boids and overlapping obstacles") {
+  BehaviorWeights weights;
+  Simulation sim(4000.f, 3000.f, 5.f, weights);
+  sim.AddBoid({100.f, 100.f}, {0.f, 0.f});
+  sim.AddBoid({3500.f, 2500.f}, {0.f, 0.f});
+  sim.AddObstacle({820.f, 300.f}, 60.f);  // center outside, edge inside
+  sim.AddObstacle({2000.f, 2000.f}, 40.f);
+
+  Rect view(0.f, 0.f, 800.f, 600.f);
+  std::vector<Boid *> boids;
+  sim.QueryBoids(view, boids);
+  REQUIRE(boids.size() == 1);
+  CHECK(boids[0]->GetPosition() == Vec2{100.f, 100.f});
+
+  std::vector<const Obstacle *> obstacles;
+  sim.QueryObstacles(view, obstacles);
+  REQUIRE(obstacles.size() == 1);
+  CHECK(obstacles[0]->GetPosition() == Vec2{820.f, 300.f});
+
+  // the index follows the boids after a step
+  sim.Step(kReferenceStep);
+  boids.clear();
+  sim.QueryBoids({3000.f, 2000.f, 1000.f, 1000.f}, boids);
+  CHECK(boids.size() == 1);
+}
+
+TEST_CASE("TripleBuffer hands the latest published state to the reader") {
+  TripleBuffer<int> buffer;
+  CHECK_FALSE(buffer.HasFresh());
+
+  buffer.WriteBuffer() = 1;
+  buffer.Publish();
+  buffer.WriteBuffer() = 2;
+  buffer.Publish();  // overwrites the unread 1
+  CHECK(buffer.HasFresh());
+  CHECK(buffer.Read() == 2);
+  CHECK(buffer.Read() == 2);  // nothing new, same buffer again
+  CHECK_FALSE(buffer.HasFresh());
+}
+
+TEST_CASE("SpscQueue keeps order and rejects pushes when full") {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) CHECK(queue.TryPush(i));
+  CHECK_FALSE(queue.TryPush(4));
+
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    REQUIRE(queue.TryPop(value));
+    CHECK(value == i);
+  }
+  CHECK_FALSE(queue.TryPop(value));
+}
+
+TEST_CASE("SimulationRunner applies commands and publishes snapshots") {
+  BehaviorWeights weights;
+  Simulation sim(800.f, 600.f, 5.f, weights);
+  SimulationRunner runner(sim, 1.f / 1000.f, 4);
+  runner.Start();
+  CHECK(runner.Send(Command::SpawnBoid({100.f, 100.f}, {0.1f, 0.f})));
+  CHECK(runner.Send(Command::PlaceObstacle({400.f, 300.f}, 40.f)));
+
+  // wait (bounded) for a snapshot taken after the commands
+  const FrameSnapshot *snapshot = &runner.AcquireSnapshot();
+  for (int i = 0; i < 2000 && snapshot->stepCount < 5; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    snapshot = &runner.AcquireSnapshot();
+  }
+  runner.Stop();
+
+  REQUIRE(snapshot->stepCount >= 5);
+  CHECK(snapshot->totalBoids == 1);
+  CHECK(snapshot->totalObstacles == 1);
+  REQUIRE(snapshot->boids.size() == 1);
+  CHECK(snapshot->boids[0].position.x > 100.f);
+}
+
+TEST_CASE("TaskGraph runs every task after its predecessors") {
+  ThreadPool pool(4);
+  TaskGraph graph;
+  std::atomic<int> clock{0};
+  std::array<int, 5> finished{};
+  auto stamp = [&](std::size_t i) {
+    return [&, i] { finished[i] = ++clock; };
+  };
+  // diamond 0 -> {1, 2} -> 3, plus an independent 4
+  auto a = graph.Add(stamp(0));
+  auto b = graph.Add(stamp(1));
+  auto c = graph.Add(stamp(2));
+  auto d = graph.Add(stamp(3));
+  graph.Add(stamp(4));
+  graph.Precede(a, b);
+  graph.Precede(a, c);
+  graph.Precede(b, d);
+  graph.Precede(c, d);
+
+  graph.Run(&pool);
+  CHECK(clock == 5);
+  CHECK(finished[0] < finished[1]);
+  CHECK(finished[0] < finished[2]);
+  CHECK(finished[1] < finished[3]);
+  CHECK(finished[2] < finished[3]);
+
+  clock = 0;
+  graph.Run(nullptr);  // serial fallback
+  CHECK(clock == 5);
+  CHECK(finished[3] > finished[1]);
+}
+
+TEST_CASE("Parallel pipelined step matches the serial step") {
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 30.f);
+  BehaviorWeights weights;
+  Simulation serial(800.f, 600.f, 5.f, weights, params);
+  Simulation parallel(800.f, 600.f, 5.f, weights, params);
+  ThreadPool pool(4);
+  parallel.SetThreadPool(&pool);
+
+  for (int i = 0; i < 600; ++i) {
+    Vec2 pos{static_cast<float>(i % 40) * 15.f + 50.f,
+             static_cast<float>(i / 40) * 15.f + 50.f};
+    Vec2 vel{0.1f * static_cast<float>(i % 3), -0.1f};
+    serial.AddBoid(pos, vel);
+    parallel.AddBoid(pos, vel);
+  }
+  serial.AddObstacle({300.f, 150.f}, 40.f);
+  parallel.AddObstacle({300.f, 150.f}, 40.f);
+
+  std::size_t consumed = 0;
+  for (int step = 0; step < 20; ++step) {
+    serial.Step(kReferenceStep);
+    parallel.Step(kReferenceStep, [&] {
+      consumed = std::as_const(parallel).GetBoids().size();
+    });
+  }
+
+  const auto &a = std::as_const(serial).GetBoids();
+  const auto &b = std::as_const(parallel).GetBoids();
+  REQUIRE(a.size() == b.size());
+  CHECK(consumed == b.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    CHECK(a[i].GetPosition() == b[i].GetPosition());
+  }
+}
+
+TEST_CASE("Parallel collisions destroy the same boids as the serial step") {
+  BehaviorWeights weights;
+  BoidParams params;
+  params.SetRadii(4.f, 2.f, 3.f, 4.f);
+  Simulation serial(800.f, 600.f, 4.f, weights, params);
+  Simulation parallel(800.f, 600.f, 4.f, weights, params);
+  ThreadPool pool(4);
+  parallel.SetThreadPool(&pool);
+
+  // several collision chunks of boids over a dense obstacle map, plus an
+  // obstacle centered outside the world that the index cannot hold
+  for (int i = 0; i < 3000; ++i) {
+    Vec2 pos{static_cast<float>(i % 75) * 10.f + 20.f,
+             static_cast<float>(i / 75) * 14.f + 20.f};
+    serial.AddBoid(pos, {0.2f, 0.1f});
+    parallel.AddBoid(pos, {0.2f, 0.1f});
+  }
+  for (int i = 0; i < 200; ++i) {
+    Vec2 pos{static_cast<float>(i % 20) * 40.f + 15.f,
+             static_cast<float>(i / 20) * 60.f + 25.f};
+    serial.AddObstacle(pos, 12.f);
+    parallel.AddObstacle(pos, 12.f);
+  }
+  serial.AddObstacle({-10.f, 300.f}, 40.f);
+  parallel.AddObstacle({-10.f, 300.f}, 40.f);
+  serial.AddBoid({5.f, 300.f}, {0.f, 0.f});
+  parallel.AddBoid({5.f, 300.f}, {0.f, 0.f});
+
+  serial.Step(kReferenceStep);
+  parallel.Step(kReferenceStep);
+  CHECK(std::as_const(serial).GetBoids().back().GetHitStatus());
+
+  for (int step = 0; step < 10; ++step) {
+    serial.Step(0.25f);
+    parallel.Step(0.25f);
+  }
+
+  const auto &a = std::as_const(serial).GetBoids();
+  const auto &b = std::as_const(parallel).GetBoids();
+  CHECK(a.size() < 3001);
+  REQUIRE(a.size() == b.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    CHECK(a[i].GetPosition() == b[i].GetPosition());
+    CHECK(a[i].GetDamage() == b[i].GetDamage());
+  }
+}
+
+TEST_CASE("Deterministic mode does not depend on the boid order") {
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 30.f);
+  BehaviorWeights weights;
+  Simulation forward(800.f, 600.f, 5.f, weights, params);
+  Simulation backward(800.f, 600.f, 5.f, weights, params);
+  ThreadPool pool(4);
+  forward.SetDeterministic(true);
+  backward.SetDeterministic(true);
+  backward.SetThreadPool(&pool);
+
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  for (int i = 0; i < 300; ++i) {
+    positions.push_back({static_cast<float>((i * 37) % 700) + 50.f,
+                         static_cast<float>((i * 53) % 500) + 50.f});
+    velocities.push_back({0.1f * static_cast<float>(i % 5) - 0.2f, 0.1f});
+  }
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    forward.AddBoid(positions[i], velocities[i]);
+    std::size_t j = positions.size() - 1 - i;
+    backward.AddBoid(positions[j], velocities[j]);
+  }
+
+  for (int step = 0; step < 20; ++step) {
+    forward.Step(kReferenceStep);
+    backward.Step(kReferenceStep);
+  }
+
+  const auto &a = std::as_const(forward).GetBoids();
+  const auto &b = std::as_const(backward).GetBoids();
+  REQUIRE(a.size() == b.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    CHECK(a[i].GetPosition() == b[a.size() - 1 - i].GetPosition());
+    CHECK(a[i].GetVelocity() == b[a.size() - 1 - i].GetVelocity());
+  }
+}
+
+TEST_CASE("Other rule kernels match the per boid rules") {
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 30.f);
+  BehaviorWeights weights;
+  ThreadPool pool(4);
+
+  // random boids (a lattice would cancel the separation down to rounding
+  // noise), some pairs sharing x, boids in the margin that see the world
+  // without being seen, and an obstacle to freeze some of them
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(7, 0, 600, {50.f, 50.f, 700.f, 500.f}, 0.3f, positions,
+               velocities);
+  for (std::size_t i = 0; i < 20; ++i) {
+    positions.push_back(positions[i] + Vec2{0.f, 7.f});
+    velocities.push_back(velocities[i]);
+  }
+  auto run = [&](Simulation &sim) {
+    sim.SetCompleteEvasion(true);
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      sim.AddBoid(positions[i], velocities[i]);
+    }
+    for (int i = 0; i < 10; ++i) {
+      sim.AddBoid({-3.f, static_cast<float>(i) * 20.f + 50.f}, {0.f, 0.1f});
+    }
+    sim.AddObstacle({300.f, 150.f}, 40.f);
+    for (int step = 0; step < 10; ++step) sim.Step(kReferenceStep);
+  };
+
+  Simulation reference(800.f, 600.f, 5.f, weights, params);
+  run(reference);
+  const auto &a = std::as_const(reference).GetBoids();
+
+  // the summed-area discs are made of whole cells, hence its looser bound
+  std::pair<RuleKernel, float> kernels[] = {{RuleKernel::Pairwise, 0.01f},
+                                            {RuleKernel::Tiled, 0.01f},
+                                            {RuleKernel::Aggregated, 0.01f},
+                                            {RuleKernel::SummedArea, 0.1f},
+                                            {RuleKernel::Verlet, 0.01f}};
+  for (auto [kernel, tolerance] : kernels) {
+    Simulation serial(800.f, 600.f, 5.f, weights, params);
+    Simulation parallel(800.f, 600.f, 5.f, weights, params);
+    serial.SetRuleKernel(kernel);
+    parallel.SetRuleKernel(kernel);
+    parallel.SetThreadPool(&pool);
+    run(serial);
+    run(parallel);
+
+    const auto &b = std::as_const(serial).GetBoids();
+    const auto &c = std::as_const(parallel).GetBoids();
+    REQUIRE(a.size() == b.size());
+    REQUIRE(b.size() == c.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      CHECK(Norm(b[i].GetPosition() - a[i].GetPosition()) < tolerance);
+      // the sums are taken in the same order at any thread count
+      CHECK(b[i].GetPosition() == c[i].GetPosition());
+    }
+  }
+}
+
+TEST_CASE("Sampled kernel is reproducible and reports its error") {
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 30.f);
+  BehaviorWeights weights;
+  ThreadPool pool(4);
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(11, 0, 800, {50.f, 50.f, 500.f, 400.f}, 0.3f, positions,
+               velocities);
+
+  Simulation reference(800.f, 600.f, 5.f, weights, params);
+  Simulation exact(800.f, 600.f, 5.f, weights, params);
+  Simulation serial(800.f, 600.f, 5.f, weights, params);
+  Simulation parallel(800.f, 600.f, 5.f, weights, params);
+  exact.SetRuleKernel(RuleKernel::Sampled);
+  exact.SetNeighborSampling(64, 100000);
+  serial.SetRuleKernel(RuleKernel::Sampled);
+  serial.SetNeighborSampling(16, 24, 9);
+  parallel.SetRuleKernel(RuleKernel::Sampled);
+  parallel.SetNeighborSampling(16, 24, 9);
+  parallel.SetThreadPool(&pool);
+  for (Simulation *sim : {&reference, &exact, &serial, &parallel}) {
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      sim->AddBoid(positions[i], velocities[i]);
+    }
+    for (int step = 0; step < 5; ++step) sim->Step(kReferenceStep);
+  }
+
+  // below the threshold nothing is sampled
+  CHECK(exact.GetSamplingReport().sampled == 0);
+  const auto &a = std::as_const(reference).GetBoids();
+  const auto &b = std::as_const(exact).GetBoids();
+  REQUIRE(a.size() == b.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    CHECK(Norm(b[i].GetPosition() - a[i].GetPosition()) < 0.01f);
+  }
+
+  // the draws depend on the seed, boid and step, not on the threads
+  const SamplingReport &report = serial.GetSamplingReport();
+  CHECK(report.sampled > 0);
+  CHECK(report.cohesion > 0.f);
+  CHECK(report.alignment > 0.f);
+  CHECK(report.cohesion < params.cohesion);
+  CHECK(report.alignment < 2 * params.maxSpeed);
+  CHECK(parallel.GetSamplingReport().sampled == report.sampled);
+  const auto &c = std::as_const(serial).GetBoids();
+  const auto &d = std::as_const(parallel).GetBoids();
+  REQUIRE(c.size() == d.size());
+  for (std::size_t i = 0; i < c.size(); ++i) {
+    CHECK(c[i].GetPosition() == d[i].GetPosition());
+  }
+}
+
+TEST_CASE("Multi-rate kernel reuses the far field between its turns") {
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 30.f);
+  BehaviorWeights weights;
+  ThreadPool pool(4);
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(13, 0, 600, {50.f, 50.f, 600.f, 450.f}, 0.3f, positions,
+               velocities);
+  auto fill = [&](Simulation &sim) {
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      sim.AddBoid(positions[i], velocities[i]);
+    }
+    sim.AddObstacle({300.f, 250.f}, 60.f);
+  };
+
+  Simulation reference(800.f, 600.f, 5.f, weights, params);
+  Simulation everyStep(800.f, 600.f, 5.f, weights, params);
+  Simulation cached(800.f, 600.f, 5.f, weights, params);
+  everyStep.SetRuleKernel(RuleKernel::MultiRate);
+  everyStep.SetMultiRatePeriod(1);
+  cached.SetRuleKernel(RuleKernel::MultiRate);
+  for (Simulation *sim : {&reference, &everyStep, &cached}) {
+    fill(*sim);
+    for (int step = 0; step < 12; ++step) sim->Step(kReferenceStep);
+  }
+  const auto &a = std::as_const(reference).GetBoids();
+  const auto &b = std::as_const(everyStep).GetBoids();
+  const auto &c = std::as_const(cached).GetBoids();
+  REQUIRE(a.size() == b.size());
+  REQUIRE(a.size() == c.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    CHECK(Norm(b[i].GetPosition() - a[i].GetPosition()) < 0.01f);
+    // a far field up to three steps old moves a boid very little
+    CHECK(Norm(c[i].GetPosition() - a[i].GetPosition()) < 0.05f);
+  }
+
+  // long steps destroy boids, which moves the cached entries along
+  Simulation serial(800.f, 600.f, 5.f, weights, params);
+  Simulation parallel(800.f, 600.f, 5.f, weights, params);
+  serial.SetRuleKernel(RuleKernel::MultiRate);
+  parallel.SetRuleKernel(RuleKernel::MultiRate);
+  parallel.SetThreadPool(&pool);
+  for (Simulation *sim : {&serial, &parallel}) {
+    fill(*sim);
+    for (int step = 0; step < 12; ++step) sim->Step(0.25f);
+  }
+  const auto &d = std::as_const(serial).GetBoids();
+  const auto &e = std::as_const(parallel).GetBoids();
+  CHECK(d.size() < positions.size());
+  REQUIRE(d.size() == e.size());
+  for (std::size_t i = 0; i < d.size(); ++i) {
+    CHECK(d[i].GetPosition() == e[i].GetPosition());
+  }
+}
+
+TEST_CASE("Verlet lists are rebuilt once a boid moved half the skin") {
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 30.f);
+  BehaviorWeights weights;
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(17, 0, 300, {100.f, 100.f, 500.f, 350.f}, 0.3f, positions,
+               velocities);
+  Simulation reference(800.f, 600.f, 5.f, weights, params);
+  Simulation sim(800.f, 600.f, 5.f, weights, params);
+  sim.SetRuleKernel(RuleKernel::Verlet);
+  sim.SetVerletSkin(6.f);
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    reference.AddBoid(positions[i], velocities[i]);
+    sim.AddBoid(positions[i], velocities[i]);
+  }
+  auto step = [&](int steps) {
+    for (int s = 0; s < steps; ++s) {
+      reference.Step(kReferenceStep);
+      sim.Step(kReferenceStep);
+    }
+  };
+  // stragglers take their neighbours from the index and are seen by all,
+  // so the steering stays that of the index between the builds
+  auto checkSame = [&] {
+    const auto &a = std::as_const(reference).GetBoids();
+    const auto &b = std::as_const(sim).GetBoids();
+    REQUIRE(a.size() == b.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      CHECK(Norm(b[i].GetPosition() - a[i].GetPosition()) < 0.01f);
+    }
+  };
+
+  // at most params.maxSpeed per tick, so 3 units take at least 10 ticks
+  step(5);
+  CHECK(sim.GetVerletBuilds() == 1);
+  checkSame();
+  step(35);
+  CHECK(sim.GetVerletBuilds() >= 2);
+  CHECK(sim.GetVerletBuilds() <= 5);
+  checkSame();
+
+  // a new boid changes the indexes
+  std::size_t builds = sim.GetVerletBuilds();
+  reference.AddBoid({400.f, 300.f}, {0.f, 0.f});
+  sim.AddBoid({400.f, 300.f}, {0.f, 0.f});
+  step(1);
+  CHECK(sim.GetVerletBuilds() == builds + 1);
+  checkSame();
+}
+
+TEST_CASE("Topological kernel takes the k nearest boids at any distance") {
+  BehaviorWeights weights;
+  BoidParams params;
+  ThreadPool pool(4);
+
+  // clusters of k + 1 boids, further apart than any radius: the k nearest
+  // are the boids within the radii
+  auto clusters = [](Simulation &sim) {
+    for (float x = 100.f; x < 800.f; x += 200.f) {
+      for (float y = 100.f; y < 600.f; y += 200.f) {
+        sim.AddBoid({x, y}, {0.1f, 0.f});
+        sim.AddBoid({x + 6.f, y + 1.f}, {0.f, 0.2f});
+        sim.AddBoid({x + 2.f, y + 7.f}, {-0.1f, 0.1f});
+        sim.AddBoid({x + 8.f, y + 9.f}, {0.2f, -0.1f});
+      }
+    }
+  };
+  Simulation metric(800.f, 600.f, 5.f, weights, params);
+  Simulation topological(800.f, 600.f, 5.f, weights, params);
+  Simulation parallel(800.f, 600.f, 5.f, weights, params);
+  topological.SetRuleKernel(RuleKernel::Topological);
+  topological.SetTopologicalNeighbors(3);
+  parallel.SetRuleKernel(RuleKernel::Topological);
+  parallel.SetTopologicalNeighbors(3);
+  parallel.SetThreadPool(&pool);
+  for (Simulation *sim : {&metric, &topological, &parallel}) {
+    clusters(*sim);
+    for (int step = 0; step < 10; ++step) sim->Step(kReferenceStep);
+  }
+  const auto &a = std::as_const(metric).GetBoids();
+  const auto &b = std::as_const(topological).GetBoids();
+  const auto &c = std::as_const(parallel).GetBoids();
+  REQUIRE(a.size() == b.size());
+  REQUIRE(b.size() == c.size());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    CHECK(Norm(b[i].GetPosition() - a[i].GetPosition()) < 0.01f);
+    CHECK(b[i].GetPosition() == c[i].GetPosition());
+  }
+
+  // two boids far out of each other's radii still close in
+  Simulation pair(800.f, 600.f, 5.f, weights, params);
+  pair.SetRuleKernel(RuleKernel::Topological);
+  pair.SetTopologicalNeighbors(1);
+  pair.AddBoid({100.f, 300.f}, {0.f, 0.f});
+  pair.AddBoid({700.f, 300.f}, {0.f, 0.f});
+  pair.Step(kReferenceStep);
+  const auto &d = std::as_const(pair).GetBoids();
+  CHECK(d[0].GetVelocity().x > 0.f);
+  CHECK(d[1].GetVelocity().x < 0.f);
+}
+
+TEST_CASE("Philox4x32-10 matches the reference vectors") {
+  // known answers from the Random123 distribution
+  CHECK(Philox4x32({0, 0, 0, 0}, {0, 0}) ==
+        PhiloxCounter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+  CHECK(Philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                   {0xffffffff, 0xffffffff}) ==
+        PhiloxCounter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+  CHECK(Philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                   {0xa4093822, 0x299f31d0}) ==
+        PhiloxCounter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("Counter based streams are reproducible and independent") {
+  CounterRng a(42, 7, 3);
+  CounterRng b(42, 7, 3);
+  CounterRng otherStep(42, 7, 4);
+  CounterRng otherStream(42, 8, 3);
+  int sameStep = 0;
+  int sameStream = 0;
+  for (int i = 0; i < 100; ++i) {
+    std::uint32_t value = a.NextU32();
+    CHECK(value == b.NextU32());
+    sameStep += value == otherStep.NextU32();
+    sameStream += value == otherStream.NextU32();
+  }
+  CHECK(sameStep < 2);
+  CHECK(sameStream < 2);
+
+  float sum = 0.f;
+  for (int i = 0; i < 10000; ++i) {
+    float value = a.NextFloat();
+    REQUIRE(value >= 0.f);
+    REQUIRE(value < 1.f);
+    sum += value;
+  }
+  CHECK(sum / 10000.f == doctest::Approx(0.5f).epsilon(0.02));
+
+  // bulk spawning gives the same boids on a pool, and boid i is the same
+  // whether it is spawned alone or in a batch
+  ThreadPool pool(4);
+  Rect area(10.f, 20.f, 300.f, 200.f);
+  std::vector<Vec2> p1, v1, p2, v2, p3, v3;
+  SpawnUniform(5, 100, 50000, area, 0.3f, p1, v1);
+  SpawnUniform(5, 100, 50000, area, 0.3f, p2, v2, &pool);
+  SpawnUniform(5, 100 + 1234, 1, area, 0.3f, p3, v3);
+  CHECK(p1 == p2);
+  CHECK(v1 == v2);
+  CHECK(p3[0] == p1[1234]);
+  CHECK(v3[0] == v1[1234]);
+  for (std::size_t i = 0; i < p1.size(); ++i) {
+    REQUIRE(area.contains(p1[i]));
+    REQUIRE(std::abs(v1[i].x) <= 0.3f);
+  }
+}
+
+TEST_CASE("Fixed-point flock follows the float rules on a torus") {
+  BehaviorWeights weights;
+  BoidParams params;
+  params.SetRadii(5.f, 4.f, 10.f, 20.f);
+  FixedFlock fixed(10, weights, params);
+  CHECK(fixed.GetWorldSize() == 1024.f);
+
+  // away from the borders the torus and the float world agree
+  Simulation sim(1024.f, 1024.f, params.radius, weights, params);
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(3, 0, 300, {350.f, 350.f, 300.f, 300.f}, params.maxSpeed,
+               positions, velocities);
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    fixed.AddBoid(positions[i], velocities[i]);
+    sim.AddBoid(positions[i], velocities[i]);
+  }
+  for (int step = 0; step < 20; ++step) {
+    fixed.Step();
+    sim.Step(kReferenceStep);
+  }
+  const auto &boids = std::as_const(sim).GetBoids();
+  REQUIRE(fixed.GetBoidCount() == boids.size());
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    CHECK(fixed.GetPosition(i).x ==
+          doctest::Approx(boids[i].GetPosition().x).epsilon(1e-4));
+    CHECK(fixed.GetPosition(i).y ==
+          doctest::Approx(boids[i].GetPosition().y).epsilon(1e-4));
+  }
+
+  // crossing a border is unsigned overflow
+  FixedFlock edge(10, weights, params);
+  edge.AddBoid({1023.9f, 512.f}, {0.25f, 0.f});
+  edge.AddBoid({-0.5f, 100.f}, {0.f, 0.f});
+  edge.Step();
+  CHECK(edge.GetPosition(0).x == doctest::Approx(0.15f).epsilon(1e-3));
+  CHECK(edge.GetPosition(1).x == doctest::Approx(1023.5f));
+}
+
+TEST_CASE("Fixed-point flock is bit-exact with and without a pool") {
+  BehaviorWeights weights;
+  BoidParams params;
+  std::vector<Vec2> positions;
+  std::vector<Vec2> velocities;
+  SpawnUniform(11, 0, 4000, {0.f, 0.f, 1024.f, 1024.f}, params.maxSpeed,
+               positions, velocities);
+
+  ThreadPool pool(4);
+  FixedFlock serial(10, weights, params);
+  FixedFlock parallel(10, weights, params);
+  parallel.SetThreadPool(&pool);
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    serial.AddBoid(positions[i], velocities[i]);
+    parallel.AddBoid(positions[i], velocities[i]);
+  }
+  for (int step = 0; step < 10; ++step) {
+    serial.Step();
+    parallel.Step();
+  }
+  CHECK(serial.Checksum() == parallel.Checksum());
+  // the same bits on every machine: a change here is a change of the model
+  CHECK(serial.Checksum() == 0xf0ddba3a64d1c886ull);
+}
+
+TEST_CASE("Composed steering matches the full rule set in every mode") {
+  // every rule evaluated, the modes checked on each call
+  auto reference = [](const Boid &boid, const std::vector<Boid *> &neighbors,
+                      const std::vector<Obstacle *> &obstacles,
+                      const BehaviorWeights &w, bool evasion, bool follow,
+                      Vec2 mouse) {
+    Vec2 force = w.separation * SepSpeed(&boid, neighbors) +
+                 w.alignment * AlnSpeed(&boid, neighbors) +
+                 w.cohesion * CohSpeed(&boid, neighbors);
+    if (boid.GetHitStatus()) force = {0.f, 0.f};
+    if (evasion) {
+      for (const Obstacle *obs : obstacles) {
+        force += w.evasion * obs->RepelBoid(boid, 20.f);
+      }
+    }
+    if (follow) {
+      Vec2 toMouse = mouse - boid.GetPosition();
+      if (Norm(toMouse) > 0.01f) force += (toMouse / Norm(toMouse)) * 0.1f;
+      if (boid.GetHitStatus()) force = {0.f, 0.f};
+    }
+    return force;
+  };
+
+  std::vector<Boid> flock;
+  for (int i = 0; i < 12; ++i) {
+    flock.emplace_back(Vec2{100.f + static_cast<float>(i % 4) * 9.f,
+                            100.f + static_cast<float>(i / 4) * 7.f},
+                       Vec2{0.1f * static_cast<float>(i % 3), -0.05f});
+  }
+  flock[5].SetHitStatus(true);
+  std::vector<Boid *> neighbors;
+  for (Boid &boid : flock) neighbors.push_back(&boid);
+  Obstacle obstacle({120.f, 95.f}, 10.f);
+  std::vector<Obstacle *> obstacles{&obstacle};
+  Vec2 mouse{300.f, 40.f};
+
+  for (unsigned mask = 0; mask < 32; ++mask) {
+    BehaviorWeights w;
+    if (!(mask & 1)) w.separation = 0.f;
+    if (!(mask & 2)) w.alignment = 0.f;
+    if (!(mask & 4)) w.cohesion = 0.f;
+    bool evasion = mask & 8;
+    bool follow = mask & 16;
+    SteeringFunction steering = SelectSteering(w, evasion, follow);
+    for (const Boid &boid : flock) {
+      Vec2 expected = reference(boid, neighbors, obstacles, w, evasion,
+                                follow, mouse);
+      Vec2 actual = steering(boid, {neighbors, obstacles, w, mouse});
+      CHECK(actual.x == doctest::Approx(expected.x).epsilon(1e-6));
+      CHECK(actual.y == doctest::Approx(expected.y).epsilon(1e-6));
+    }
+  }
+
+  // rules that cannot contribute are compiled out
+  BehaviorWeights noAlignment;
+  noAlignment.alignment = 0.f;
+  CHECK(SelectSteering(noAlignment, false, false) !=
+        SelectSteering(BehaviorWeights{}, false, false));
+}
+
+TEST_CASE("CostModel splits boids into chunks of equal predicted cost") {
+  CostModel model;
+  // a dense clump at the front, lonely boids behind it
+  std::vector<std::uint32_t> counts(1000, 0);
+  for (std::size_t i = 0; i < 100; ++i) counts[i] = 200;
+
+  std::vector<std::size_t> bounds;
+  model.Partition(counts, 4, bounds);
+  REQUIRE(bounds.size() == 5);
+  CHECK(bounds.front() == 0);
+  CHECK(bounds.back() == counts.size());
+
+  double total = 0.0;
+  for (std::uint32_t n : counts) total += model.PredictCost(n);
+  for (std::size_t c = 0; c + 1 < bounds.size(); ++c) {
+    CHECK(bounds[c] < bounds[c + 1]);
+    double cost = 0.0;
+    for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+      cost += model.PredictCost(counts[i]);
+    }
+    // within one dense boid of the ideal share
+    CHECK(std::abs(cost - total / 4) <= model.PredictCost(200));
+  }
+  // the clump is spread over more than one chunk
+  CHECK(bounds[1] < 100);
+
+  // never more chunks than boids
+  model.Partition({3, 3}, 8, bounds);
+  CHECK(bounds.size() == 3);
+}
+
+TEST_CASE("CostModel fits the per boid overhead from chunk timings") {
+  CostModel model;
+  // chunks timed as 2 units per boid plus 0.1 per neighbor
+  std::vector<ChunkSample> samples;
+  for (std::size_t c = 1; c <= 8; ++c) {
+    std::size_t boids = 100 * c;
+    std::size_t neighbors = 5000 / c;
+    double cost = 2.0 * static_cast<double>(boids) +
+                  0.1 * static_cast<double>(neighbors);
+    samples.push_back({boids, neighbors, static_cast<float>(cost) * 1e-6f});
+  }
+  for (int i = 0; i < 50; ++i) model.Fit(samples);
+  CHECK(model.GetBoidOverhead() == doctest::Approx(20.f).epsilon(0.01));
+
+  // uniform chunks carry no information and leave the model alone
+  CostModel untouched;
+  untouched.Fit({{100, 1000, 1e-3f}, {100, 1000, 1e-3f}});
+  CHECK(untouched.GetBoidOverhead() == CostModel().GetBoidOverhead());
+}
+
+TEST_CASE("Simulations keep their parameters apart") {
+  BehaviorWeights weights;
+  BoidParams slow;
+  slow.maxSpeed = 0.01f;
+  BoidParams fast;
+  fast.SetRadii(8.f, 2.f, 5.f, 10.f);
+  fast.maxSpeed = 1.f;
+
+  Simulation a(800.f, 600.f, 5.f, weights, slow);
+  Simulation b(800.f, 600.f, 5.f, weights, fast);
+  a.AddBoid({100.f, 100.f}, {0.f, 0.f});
+  b.AddBoid({100.f, 100.f}, {0.f, 0.f});
+  CHECK(a.GetBoids()[0].GetRadius() == doctest::Approx(5.f));
+  CHECK(b.GetBoids()[0].GetRadius() == doctest::Approx(8.f));
+  CHECK(b.GetBoids()[0].GetRadiusAlg() == doctest::Approx(80.f));
+
+  a.GetBoids()[0].SpeedChange({1.f, 0.f});
+  b.GetBoids()[0].SpeedChange({1.f, 0.f});
+  CHECK(Norm(a.GetBoids()[0].GetVelocity()) == doctest::Approx(0.01f));
+  CHECK(Norm(b.GetBoids()[0].GetVelocity()) == doctest::Approx(1.f));
+
+  // evasion is a mode of one simulation only
+  a.SetCompleteEvasion(true);
+  CHECK(a.GetCompleteEvasion());
+  CHECK_FALSE(b.GetCompleteEvasion());
+}
+
+TEST_CASE("Ensemble results do not depend on the pool") {
+  EnsembleSettings settings;
+  settings.boids = 60;
+  settings.steps = 30;
+  std::vector<EnsembleMember> members(6);
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    members[i].seed = static_cast<std::uint32_t>(i % 3);
+    members[i].weights.cohesion = 1e-4f * static_cast<float>(i + 1);
+  }
+
+  ThreadPool pool(4);
+  std::vector<EnsembleSummary> serial = RunEnsemble(settings, members, nullptr);
+  std::vector<EnsembleSummary> parallel = RunEnsemble(settings, members, &pool);
+  REQUIRE(serial.size() == members.size());
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    CHECK(serial[i].boids == settings.boids);
+    CHECK(serial[i].polarization >= 0.f);
+    CHECK(serial[i].polarization <= 1.f + EPS);
+    CHECK(parallel[i].meanSpeed == serial[i].meanSpeed);
+    CHECK(parallel[i].polarization == serial[i].polarization);
+    CHECK(parallel[i].meanNeighbors == serial[i].meanNeighbors);
+  }
+
+  std::ostringstream table;
+  WriteSummaryTable(table, members, serial);
+  std::string text = table.str();
+  CHECK(std::count(text.begin(), text.end(), '\n') ==
+        static_cast<long>(members.size() + 1));  // header and one row each
+}
+
+TEST_CASE("Lane ensemble steps every world like its own simulation") {
+  EnsembleSettings settings;
+  settings.width = 200.f;
+  settings.height = 150.f;
+  settings.boids = 40;
+  std::vector<EnsembleMember> members(5);
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    members[i].seed = static_cast<std::uint32_t>(i);
+    members[i].weights.separation = 1e-3f * static_cast<float>(i + 1);
+    members[i].params.SetRadii(2.f + static_cast<float>(i), 4.f, 10.f, 20.f);
+  }
+
+  LaneEnsemble lanes(settings, members);
+  REQUIRE(lanes.GetWorldCount() == members.size());
+  for (int step = 0; step < 30; ++step) lanes.Step(settings.step);
+
+  for (std::size_t w = 0; w < members.size(); ++w) {
+    const EnsembleMember &member = members[w];
+    Simulation sim(settings.width, settings.height, member.params.radius,
+                   member.weights, member.params);
+    std::vector<Vec2> positions;
+    std::vector<Vec2> velocities;
+    InitialState(settings, member, positions, velocities);
+    for (std::size_t b = 0; b < positions.size(); ++b) {
+      sim.AddBoid(positions[b], velocities[b]);
+    }
+    for (int step = 0; step < 30; ++step) sim.Step(settings.step);
+
+    // only the summation order of the neighbours differs
+    const auto &boids = std::as_const(sim).GetBoids();
+    REQUIRE(boids.size() == lanes.GetBoidCount());
+    for (std::size_t b = 0; b < boids.size(); ++b) {
+      Vec2 expected = boids[b].GetPosition();
+      Vec2 actual = lanes.GetPosition(w, b);
+      CHECK(actual.x == doctest::Approx(expected.x).epsilon(1e-3));
+      CHECK(actual.y == doctest::Approx(expected.y).epsilon(1e-3));
+    }
+  }
+
+  // blocks of lanes on a pool give the same summaries as one block
+  ThreadPool pool(3);
+  settings.steps = 10;
+  auto blocked = RunLaneEnsemble(settings, members, &pool, 2);
+  auto single = RunLaneEnsemble(settings, members, nullptr, members.size());
+  REQUIRE(blocked.size() == members.size());
+  for (std::size_t w = 0; w < members.size(); ++w) {
+    CHECK(blocked[w].meanSpeed == single[w].meanSpeed);
+    CHECK(blocked[w].meanNeighbors == single[w].meanNeighbors);
+  }
+}
+
+#ifdef BOID_HAS_DISTRIBUTED
+TEST_CASE("Channels exchange messages larger than the socket buffers") {
+  Channel a, b;
+  REQUIRE(Channel::CreatePair(a, b));
+
+  // both ends send at once, neither may wait for the other to read first
+  std::vector<int> fromA(1 << 20, 1);
+  std::vector<int> fromB(1 << 19, 2);
+  std::vector<std::vector<char>> outA(1), outB(1), inA, inB;
+  Pack(fromA, outA[0]);
+  Pack(fromB, outB[0]);
+  bool okB = false;
+  std::thread other([&] { okB = Exchange({&b}, outB, inB); });
+  bool okA = Exchange({&a}, outA, inA);
+  other.join();
+  REQUIRE(okA);
+  REQUIRE(okB);
+
+  std::vector<int> received;
+  REQUIRE(Unpack(inA[0], received));
+  CHECK(received == fromB);
+  REQUIRE(Unpack(inB[0], received));
+  CHECK(received == fromA);
+
+  // blocking messages, an empty one included, then the peer going away
+  std::vector<char> message;
+  REQUIRE(a.Send({}));
+  REQUIRE(b.Receive(message));
+  CHECK(message.empty());
+  a.Close();
+  CHECK_FALSE(b.Receive(message));
+}
+
+TEST_CASE("Strip decomposition owns the whole line") {
+  StripDecomposition strips(900.f, 3);
+  CHECK(strips.OwnerOf(-5.f) == 0);
+  CHECK(strips.OwnerOf(299.f) == 0);
+  CHECK(strips.OwnerOf(300.f) == 1);
+  CHECK(strips.OwnerOf(899.f) == 2);
+  CHECK(strips.OwnerOf(905.f) == 2);
+  CHECK(strips.GetRight(1) == strips.GetLeft(2));
+}
+
+TEST_CASE("Distributed run matches a single simulation") {
+  DomainSettings settings;
+  settings.width = 900.f;
+  settings.height = 300.f;
+  settings.ranks = 3;
+  settings.steps = 60;
+
+  // a dense flock drifting across both strip borders
+  std::mt19937 engine(7);
+  std::uniform_real_distribution<float> x_dist(0.f, settings.width);
+  std::uniform_real_distribution<float> y_dist(0.f, settings.height);
+  std::uniform_real_distribution<float> v_dist(0.1f, 0.3f);
+  std::vector<BoidRecord> initial(300);
+  for (BoidRecord &record : initial) {
+    record.position = {x_dist(engine), y_dist(engine)};
+    record.velocity = {v_dist(engine), 0.f};
+  }
+  std::vector<Obstacle> obstacles{Obstacle({450.f, 150.f}, 40.f)};
+
+  Simulation sim(settings.width, settings.height, settings.margin,
+                 settings.weights, settings.params);
+  for (const BoidRecord &record : initial) {
+    sim.AddBoid(record.position, record.velocity);
+  }
+  sim.AddObstacle({450.f, 150.f}, 40.f);
+  for (int step = 0; step < settings.steps; ++step) sim.Step(settings.step);
+
+  std::vector<BoidRecord> result;
+  std::vector<DomainStats> stats;
+  REQUIRE(RunDistributed(settings, initial, obstacles, result, &stats));
+  REQUIRE(stats.size() == 3);
+  std::uint64_t migrated = 0;
+  for (const DomainStats &rank : stats) {
+    CHECK(rank.steps == static_cast<std::uint64_t>(settings.steps));
+    CHECK(rank.haloSent > 0);
+    migrated += rank.migrated;
+  }
+  CHECK(migrated > 0);
+
+  // the boids come back grouped by rank, and only the summation order of
+  // the neighbours differs, so every one has a close match
+  const auto &boids = std::as_const(sim).GetBoids();
+  REQUIRE(result.size() == boids.size());
+  for (const BoidRecord &record : result) {
+    float best = DistSqr(boids[0].GetPosition(), record.position);
+    for (const Boid &boid : boids) {
+      best = std::min(best, DistSqr(boid.GetPosition(), record.position));
+    }
+    CHECK(best < 1e-4f);
+  }
+
+  // a single rank needs no channels and keeps the order of the boids
+  settings.ranks = 1;
+  REQUIRE(RunDistributed(settings, initial, obstacles, result));
+  REQUIRE(result.size() == boids.size());
+  for (std::size_t i = 0; i < boids.size(); ++i) {
+    CHECK(result[i].position == boids[i].GetPosition());
+  }
+
+  // in deterministic mode the split no longer shows in the results
+  settings.ranks = 3;
+  settings.deterministic = true;
+  Simulation canonical(settings.width, settings.height, settings.margin,
+                       settings.weights, settings.params);
+  canonical.SetDeterministic(true);
+  for (const BoidRecord &record : initial) {
+    canonical.AddBoid(record.position, record.velocity);
+  }
+  canonical.AddObstacle({450.f, 150.f}, 40.f);
+  for (int step = 0; step < settings.steps; ++step) {
+    canonical.Step(settings.step);
+  }
+  REQUIRE(RunDistributed(settings, initial, obstacles, result));
+  std::vector<const Boid *> sorted;
+  for (const Boid &boid : std::as_const(canonical).GetBoids()) {
+    sorted.push_back(&boid);
+  }
+  std::sort(result.begin(), result.end(),
+            [](const BoidRecord &r1, const BoidRecord &r2) {
+              Boid b1(r1.position, r1.velocity), b2(r2.position, r2.velocity);
+              return CanonicalLess(&b1, &b2);
+            });
+  std::sort(sorted.begin(), sorted.end(), CanonicalLess);
+  REQUIRE(result.size() == sorted.size());
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    CHECK(result[i].position == sorted[i]->GetPosition());
+    CHECK(result[i].velocity == sorted[i]->GetVelocity());
+  }
+  settings.deterministic = false;
+
+  // strips narrower than the alignment radius are refused
+  settings.ranks = 7;
+  CHECK_FALSE(RunDistributed(settings, initial, obstacles, result));
+}
+#endif